@@ -9,7 +9,7 @@
  *  - `list` - list the coroutines managed by the CoroutineScheduler
  *  - `free` - print free memory
  *  - `echo [args ...]` - echo the arguments
- *  - `delay (on | off) millis` - set LED blink on or off delay
+ *  - `delay [(on | off) millis]` - set LED blink on or off delay
  */
 
 #include <Arduino.h>
@@ -20,6 +20,9 @@
 
 using ace_routine::CoroutineScheduler;
 using ace_utils::cli::CommandHandler;
+using ace_utils::cli::SchemaCommandHandler;
+using ace_utils::cli::ArgSpec;
+using ace_utils::cli::ArgValue;
 using ace_utils::cli::ChannelProcessorManager;
 using ace_utils::freemem::freeMemory;
 
@@ -97,40 +100,37 @@ class FreeCommand: public CommandHandler {
     }
 };
 
+static const char DELAY_MODES[] PROGMEM = "on|off";
+static const char DELAY_MILLIS[] PROGMEM = "millis";
+static const ArgSpec DELAY_SCHEMA[] PROGMEM = {
+  {ArgSpec::kTypeEnum, ArgSpec::kFlagOptional, DELAY_MODES, 0, 0},
+  {ArgSpec::kTypeInt, 0, DELAY_MILLIS, 1, 30000},
+};
+
 /**
  * Change the blinking LED on and off delay parameters. If no argument given,
- * simply print out the current values. Demonstrates the use of shiftArgcArgv()
- * and the isArgEqual() helper method.
+ * simply print out the current values. Demonstrates the use of
+ * SchemaCommandHandler, which validates the arguments according to
+ * DELAY_SCHEMA and generates the help string from it.
  */
-class DelayCommand: public CommandHandler {
+class DelayCommand: public SchemaCommandHandler {
   public:
     DelayCommand():
-        CommandHandler(F("delay"), F("[(on | off) millis]")) {}
+        SchemaCommandHandler(F("delay"), DELAY_SCHEMA,
+            sizeof(DELAY_SCHEMA) / sizeof(ArgSpec)) {}
 
-    void run(Print& printer, int argc, const char* const* argv) const override {
-      if (argc == 1) {
+  protected:
+    void runArgs(Print& printer, const ArgValue* args, uint8_t numArgs)
+        const override {
+      if (numArgs == 0) {
         printer.print(F("LED_ON delay: "));
         printer.println(ledOnDelay);
         printer.print(F("LED_OFF delay: "));
         printer.println(ledOffDelay);
-        return;
-      }
-
-      if (argc < 3) {
-        printer.println(F("Invalid number of arguments"));
-        return;
-      }
-
-      shiftArgcArgv(argc, argv);
-      if (isArgEqual(argv[0], F("on"))) {
-        shiftArgcArgv(argc, argv);
-        ledOnDelay = atoi(argv[0]);
-      } else if (isArgEqual(argv[0], F("off"))) {
-        shiftArgcArgv(argc, argv);
-        ledOffDelay = atoi(argv[0]);
+      } else if (args[0].e == 0) {
+        ledOnDelay = args[1].i;
       } else {
-        printer.print(F("Unknown argument: "));
-        printer.println(argv[0]);
+        ledOffDelay = args[1].i;
       }
     }
 };
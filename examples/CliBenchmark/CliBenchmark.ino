@@ -0,0 +1,510 @@
+/*
+ * Benchmark of the AceUtils/cli/cli.h classes. Feeds a synthetic stream of
+ * commands through the DirectProcessorManager, StreamProcessorManager and
+ * ChannelProcessorManager, for a small and a large BUF_SIZE/ARGV_SIZE and a
+ * small and a large command table, and prints:
+ *
+ *  - throughput: commands per second and nanos per input byte, when the whole
+ *    script is available at once (e.g. pasted into the terminal)
+ *  - latency: p50 and p99 micros to dispatch a single line
+ *  - idle cost: nanos per scheduler pass over the idle StreamProcessorManager
+ *    coroutines, when they poll the Stream and when they are suspended until
+ *    wakeup()
+ *
+ * Run on EpoxyDuino using 'make && ./CliBenchmark.out', or upload to a
+ * microcontroller and read the results on the serial port.
+ */
+
+#include <Arduino.h>
+#include <AceRoutine.h>
+#include <AceUtils.h>
+#include <cli/cli.h> // from AceUtils
+
+using ace_utils::cli::CommandHandler;
+using ace_utils::cli::ProgmemCommand;
+using ace_utils::cli::line_size_t;
+using ace_utils::cli::DirectProcessorManager;
+using ace_utils::cli::StreamProcessorManager;
+using ace_utils::cli::ChannelProcessorManager;
+using ace_utils::cli::StreamProcessorCoroutine;
+
+#if ! defined(SERIAL_PORT_MONITOR)
+  #define SERIAL_PORT_MONITOR Serial
+#endif
+
+//---------------------------------------------------------------------------
+// Test fixtures.
+//---------------------------------------------------------------------------
+
+/** Number of times any BenchCommand was executed. */
+static uint16_t numRuns;
+
+/** A command that does nothing except count its invocations. */
+class BenchCommand: public CommandHandler {
+  public:
+    BenchCommand(const __FlashStringHelper* name):
+        CommandHandler(name, nullptr) {}
+
+    void run(Print& /*printer*/, int /*argc*/, const char* const* /*argv*/)
+        const override {
+      numRuns++;
+    }
+};
+
+/** The function of each ProgmemCommand, equivalent to BenchCommand. */
+static void benchFunction(Print& /*printer*/, int /*argc*/,
+    const char* const* /*argv*/) {
+  numRuns++;
+}
+
+/** A Print that throws away its output. */
+class NullPrint: public Print {
+  public:
+    size_t write(uint8_t) override { return 1; }
+    size_t write(const uint8_t* /*buffer*/, size_t size) override {
+      return size;
+    }
+};
+
+/** Arguments of each line of the script. */
+static const char SCRIPT_ARGS[] = " arg1 arg2\n";
+
+/**
+ * A Stream that generates a script of commands on the fly, so that the script
+ * uses no RAM. Line i is "cmdNN arg1 arg2", where the command cycles through
+ * the first 'tableSize' entries of COMMANDS. Only the bytes released by
+ * arrive() are reported by available(), to simulate bytes arriving on a serial
+ * port.
+ */
+class ScriptStream: public Stream {
+  public:
+    void setScript(uint8_t numLines, uint8_t tableSize) {
+      mNumLines = numLines;
+      mTableSize = tableSize;
+      mSize = 0;
+      for (uint8_t i = 0; i < numLines; i++) {
+        mSize += lineLength(i);
+      }
+      mConsumed = 0;
+      mAvailable = 0;
+      mLineIndex = 0;
+      loadLine();
+    }
+
+    /** Return the total number of bytes of the script. */
+    size_t size() const { return mSize; }
+
+    /** Return the length of line i, including the newline. */
+    uint8_t lineLength(uint8_t i) const {
+      return strlen_P(commandName(i)) + sizeof(SCRIPT_ARGS) - 1;
+    }
+
+    /** Release the next 'n' bytes, or all the remaining bytes if 0. */
+    void arrive(size_t n = 0) {
+      size_t remaining = mSize - mConsumed;
+      mAvailable = (n == 0 || n > remaining) ? remaining : n;
+    }
+
+    int available() override { return mAvailable; }
+
+    int read() override {
+      if (mAvailable == 0) return -1;
+      mAvailable--;
+      mConsumed++;
+      char c = mLine[mPos++];
+      if (mPos >= mLineLen) {
+        mLineIndex++;
+        loadLine();
+      }
+      return c;
+    }
+
+    int peek() override { return (mAvailable == 0) ? -1 : mLine[mPos]; }
+
+    size_t write(uint8_t) override { return 1; }
+
+  private:
+    const char* commandName(uint8_t i) const;
+
+    void loadLine() {
+      mPos = 0;
+      if (mLineIndex >= mNumLines) {
+        mLineLen = 0;
+        return;
+      }
+      strcpy_P(mLine, commandName(mLineIndex));
+      strcat(mLine, SCRIPT_ARGS);
+      mLineLen = strlen(mLine);
+    }
+
+    char mLine[24];
+    size_t mSize = 0;
+    size_t mConsumed = 0;
+    size_t mAvailable = 0;
+    uint8_t mNumLines = 0;
+    uint8_t mTableSize = 1;
+    uint8_t mLineIndex = 0;
+    uint8_t mLineLen = 0;
+    uint8_t mPos = 0;
+};
+
+#define BENCH_NAME(n) const char NAME##n[] PROGMEM = "cmd" #n;
+#define BENCH_COMMAND(n) BenchCommand((const __FlashStringHelper*) NAME##n)
+
+BENCH_NAME(00) BENCH_NAME(01) BENCH_NAME(02) BENCH_NAME(03) BENCH_NAME(04)
+BENCH_NAME(05) BENCH_NAME(06) BENCH_NAME(07) BENCH_NAME(08) BENCH_NAME(09)
+BENCH_NAME(10) BENCH_NAME(11) BENCH_NAME(12) BENCH_NAME(13) BENCH_NAME(14)
+BENCH_NAME(15) BENCH_NAME(16) BENCH_NAME(17) BENCH_NAME(18) BENCH_NAME(19)
+BENCH_NAME(20) BENCH_NAME(21) BENCH_NAME(22) BENCH_NAME(23) BENCH_NAME(24)
+BENCH_NAME(25) BENCH_NAME(26) BENCH_NAME(27) BENCH_NAME(28) BENCH_NAME(29)
+BENCH_NAME(30) BENCH_NAME(31) BENCH_NAME(32) BENCH_NAME(33) BENCH_NAME(34)
+BENCH_NAME(35) BENCH_NAME(36) BENCH_NAME(37) BENCH_NAME(38) BENCH_NAME(39)
+
+static const BenchCommand BENCH_COMMANDS[] = {
+  BENCH_COMMAND(00), BENCH_COMMAND(01), BENCH_COMMAND(02), BENCH_COMMAND(03),
+  BENCH_COMMAND(04), BENCH_COMMAND(05), BENCH_COMMAND(06), BENCH_COMMAND(07),
+  BENCH_COMMAND(08), BENCH_COMMAND(09), BENCH_COMMAND(10), BENCH_COMMAND(11),
+  BENCH_COMMAND(12), BENCH_COMMAND(13), BENCH_COMMAND(14), BENCH_COMMAND(15),
+  BENCH_COMMAND(16), BENCH_COMMAND(17), BENCH_COMMAND(18), BENCH_COMMAND(19),
+  BENCH_COMMAND(20), BENCH_COMMAND(21), BENCH_COMMAND(22), BENCH_COMMAND(23),
+  BENCH_COMMAND(24), BENCH_COMMAND(25), BENCH_COMMAND(26), BENCH_COMMAND(27),
+  BENCH_COMMAND(28), BENCH_COMMAND(29), BENCH_COMMAND(30), BENCH_COMMAND(31),
+  BENCH_COMMAND(32), BENCH_COMMAND(33), BENCH_COMMAND(34), BENCH_COMMAND(35),
+  BENCH_COMMAND(36), BENCH_COMMAND(37), BENCH_COMMAND(38), BENCH_COMMAND(39),
+};
+
+// The table is deliberately *not* sorted by name (it is reversed), so that
+// CommandDispatcher uses the linear scan. This measures the worst case.
+static const CommandHandler* const COMMANDS[] = {
+  &BENCH_COMMANDS[39], &BENCH_COMMANDS[38], &BENCH_COMMANDS[37],
+  &BENCH_COMMANDS[36], &BENCH_COMMANDS[35], &BENCH_COMMANDS[34],
+  &BENCH_COMMANDS[33], &BENCH_COMMANDS[32], &BENCH_COMMANDS[31],
+  &BENCH_COMMANDS[30], &BENCH_COMMANDS[29], &BENCH_COMMANDS[28],
+  &BENCH_COMMANDS[27], &BENCH_COMMANDS[26], &BENCH_COMMANDS[25],
+  &BENCH_COMMANDS[24], &BENCH_COMMANDS[23], &BENCH_COMMANDS[22],
+  &BENCH_COMMANDS[21], &BENCH_COMMANDS[20], &BENCH_COMMANDS[19],
+  &BENCH_COMMANDS[18], &BENCH_COMMANDS[17], &BENCH_COMMANDS[16],
+  &BENCH_COMMANDS[15], &BENCH_COMMANDS[14], &BENCH_COMMANDS[13],
+  &BENCH_COMMANDS[12], &BENCH_COMMANDS[11], &BENCH_COMMANDS[10],
+  &BENCH_COMMANDS[9], &BENCH_COMMANDS[8], &BENCH_COMMANDS[7],
+  &BENCH_COMMANDS[6], &BENCH_COMMANDS[5], &BENCH_COMMANDS[4],
+  &BENCH_COMMANDS[3], &BENCH_COMMANDS[2], &BENCH_COMMANDS[1],
+  &BENCH_COMMANDS[0],
+};
+#define BENCH_ENTRY(n) {NAME##n, nullptr, benchFunction}
+
+// The same commands, in the same order, in a PROGMEM table.
+static const ProgmemCommand PROGMEM_COMMANDS[] PROGMEM = {
+  BENCH_ENTRY(39), BENCH_ENTRY(38), BENCH_ENTRY(37), BENCH_ENTRY(36),
+  BENCH_ENTRY(35), BENCH_ENTRY(34), BENCH_ENTRY(33), BENCH_ENTRY(32),
+  BENCH_ENTRY(31), BENCH_ENTRY(30), BENCH_ENTRY(29), BENCH_ENTRY(28),
+  BENCH_ENTRY(27), BENCH_ENTRY(26), BENCH_ENTRY(25), BENCH_ENTRY(24),
+  BENCH_ENTRY(23), BENCH_ENTRY(22), BENCH_ENTRY(21), BENCH_ENTRY(20),
+  BENCH_ENTRY(19), BENCH_ENTRY(18), BENCH_ENTRY(17), BENCH_ENTRY(16),
+  BENCH_ENTRY(15), BENCH_ENTRY(14), BENCH_ENTRY(13), BENCH_ENTRY(12),
+  BENCH_ENTRY(11), BENCH_ENTRY(10), BENCH_ENTRY(09), BENCH_ENTRY(08),
+  BENCH_ENTRY(07), BENCH_ENTRY(06), BENCH_ENTRY(05), BENCH_ENTRY(04),
+  BENCH_ENTRY(03), BENCH_ENTRY(02), BENCH_ENTRY(01), BENCH_ENTRY(00),
+};
+
+const char* ScriptStream::commandName(uint8_t i) const {
+  return (const char*) COMMANDS[i % mTableSize]->getName().getFString();
+}
+
+static const uint8_t SMALL_TABLE = 4;
+static const uint8_t LARGE_TABLE = sizeof(COMMANDS) / sizeof(CommandHandler*);
+
+static const uint8_t SMALL_BUF_SIZE = 32;
+static const uint8_t SMALL_ARGV_SIZE = 4;
+static const uint8_t LARGE_BUF_SIZE = 64;
+static const uint8_t LARGE_ARGV_SIZE = 8;
+
+static ScriptStream stream;
+static NullPrint nullPrint;
+
+DirectProcessorManager<SMALL_BUF_SIZE, SMALL_ARGV_SIZE> directSmallSmall(
+    stream, COMMANDS, SMALL_TABLE, nullPrint);
+DirectProcessorManager<SMALL_BUF_SIZE, SMALL_ARGV_SIZE> directSmallLarge(
+    stream, COMMANDS, LARGE_TABLE, nullPrint);
+// The 64/8 configurations are left out on AVR, to leave room in the 2 kB of
+// RAM of an ATmega328P for the 40 command handlers and the other managers.
+#if ! defined(ARDUINO_ARCH_AVR)
+  #define BENCH_LARGE_BUFFERS 1
+#else
+  #define BENCH_LARGE_BUFFERS 0
+#endif
+
+#if BENCH_LARGE_BUFFERS
+DirectProcessorManager<LARGE_BUF_SIZE, LARGE_ARGV_SIZE> directLargeSmall(
+    stream, COMMANDS, SMALL_TABLE, nullPrint);
+DirectProcessorManager<LARGE_BUF_SIZE, LARGE_ARGV_SIZE> directLargeLarge(
+    stream, COMMANDS, LARGE_TABLE, nullPrint);
+#endif
+
+DirectProcessorManager<SMALL_BUF_SIZE, SMALL_ARGV_SIZE> progmemSmallSmall(
+    stream, PROGMEM_COMMANDS, SMALL_TABLE, nullPrint);
+DirectProcessorManager<SMALL_BUF_SIZE, SMALL_ARGV_SIZE> progmemSmallLarge(
+    stream, PROGMEM_COMMANDS, LARGE_TABLE, nullPrint);
+
+StreamProcessorManager<SMALL_BUF_SIZE, SMALL_ARGV_SIZE> streamSmallSmall(
+    stream, COMMANDS, SMALL_TABLE, nullPrint);
+StreamProcessorManager<SMALL_BUF_SIZE, SMALL_ARGV_SIZE> streamSmallLarge(
+    stream, COMMANDS, LARGE_TABLE, nullPrint);
+#if BENCH_LARGE_BUFFERS
+StreamProcessorManager<LARGE_BUF_SIZE, LARGE_ARGV_SIZE> streamLargeSmall(
+    stream, COMMANDS, SMALL_TABLE, nullPrint);
+StreamProcessorManager<LARGE_BUF_SIZE, LARGE_ARGV_SIZE> streamLargeLarge(
+    stream, COMMANDS, LARGE_TABLE, nullPrint);
+#endif
+
+ChannelProcessorManager<SMALL_BUF_SIZE, SMALL_ARGV_SIZE> channelSmallSmall(
+    stream, COMMANDS, SMALL_TABLE, nullPrint);
+ChannelProcessorManager<SMALL_BUF_SIZE, SMALL_ARGV_SIZE> channelSmallLarge(
+    stream, COMMANDS, LARGE_TABLE, nullPrint);
+#if BENCH_LARGE_BUFFERS
+ChannelProcessorManager<LARGE_BUF_SIZE, LARGE_ARGV_SIZE> channelLargeSmall(
+    stream, COMMANDS, SMALL_TABLE, nullPrint);
+ChannelProcessorManager<LARGE_BUF_SIZE, LARGE_ARGV_SIZE> channelLargeLarge(
+    stream, COMMANDS, LARGE_TABLE, nullPrint);
+#endif
+
+//---------------------------------------------------------------------------
+// Drivers. Each one runs the processor until the stream is drained.
+//---------------------------------------------------------------------------
+
+template <line_size_t BUF_SIZE, uint8_t ARGV_SIZE>
+void drive(DirectProcessorManager<BUF_SIZE, ARGV_SIZE>& manager) {
+  manager.process();
+}
+
+template <line_size_t BUF_SIZE, uint8_t ARGV_SIZE>
+void drive(StreamProcessorManager<BUF_SIZE, ARGV_SIZE>& manager) {
+  manager.getStreamProcessor().runCoroutine();
+}
+
+template <uint8_t BUF_SIZE, uint8_t ARGV_SIZE>
+void drive(ChannelProcessorManager<BUF_SIZE, ARGV_SIZE>& manager) {
+  manager.getStreamReader().runCoroutine();
+  manager.getChannelProcessor().runCoroutine();
+}
+
+//---------------------------------------------------------------------------
+// Benchmark runner.
+//---------------------------------------------------------------------------
+
+static const uint8_t NUM_LINES = 100;
+
+// Latency of each line, in micros.
+static uint16_t latencies[NUM_LINES];
+
+/** Sort the latencies using insertion sort. */
+static void sortLatencies() {
+  for (uint8_t i = 1; i < NUM_LINES; i++) {
+    uint16_t value = latencies[i];
+    uint8_t j = i;
+    while (j > 0 && latencies[j - 1] > value) {
+      latencies[j] = latencies[j - 1];
+      j--;
+    }
+    latencies[j] = value;
+  }
+}
+
+template <typename M>
+static void runBenchmark(
+    const __FlashStringHelper* name,
+    M& manager,
+    uint8_t bufSize,
+    uint8_t argvSize,
+    uint8_t tableSize) {
+
+  // Throughput: make the whole script available, then drain it.
+  stream.setScript(NUM_LINES, tableSize);
+  size_t scriptSize = stream.size();
+  stream.arrive();
+  numRuns = 0;
+  unsigned long startMicros = micros();
+  while (numRuns < NUM_LINES) {
+    drive(manager);
+  }
+  unsigned long elapsedMicros = micros() - startMicros;
+  if (elapsedMicros == 0) elapsedMicros = 1;
+
+  // Latency: release one line at a time.
+  stream.setScript(NUM_LINES, tableSize);
+  numRuns = 0;
+  for (uint8_t i = 0; i < NUM_LINES; i++) {
+    stream.arrive(stream.lineLength(i));
+    unsigned long start = micros();
+    while (numRuns <= i) {
+      drive(manager);
+    }
+    unsigned long elapsed = micros() - start;
+    latencies[i] = (elapsed > 0xFFFF) ? 0xFFFF : elapsed;
+  }
+  sortLatencies();
+
+  unsigned long commandsPerSec =
+      (unsigned long) ((uint64_t) NUM_LINES * 1000000 / elapsedMicros);
+  unsigned long nanosPerByte =
+      (unsigned long) ((uint64_t) elapsedMicros * 1000 / scriptSize);
+
+  SERIAL_PORT_MONITOR.print(name);
+  SERIAL_PORT_MONITOR.print(' ');
+  SERIAL_PORT_MONITOR.print(bufSize);
+  SERIAL_PORT_MONITOR.print(' ');
+  SERIAL_PORT_MONITOR.print(argvSize);
+  SERIAL_PORT_MONITOR.print(' ');
+  SERIAL_PORT_MONITOR.print(tableSize);
+  SERIAL_PORT_MONITOR.print(' ');
+  SERIAL_PORT_MONITOR.print(commandsPerSec);
+  SERIAL_PORT_MONITOR.print(' ');
+  SERIAL_PORT_MONITOR.print(nanosPerByte);
+  SERIAL_PORT_MONITOR.print(' ');
+  SERIAL_PORT_MONITOR.print(latencies[NUM_LINES / 2]);
+  SERIAL_PORT_MONITOR.print(' ');
+  SERIAL_PORT_MONITOR.println(latencies[NUM_LINES * 99 / 100]);
+}
+
+/**
+ * Print the size of the command table of LARGE_TABLE entries in both layouts:
+ * the CommandHandler objects and the array of pointers to them, which are in
+ * RAM, and the ProgmemCommand table, which is in PROGMEM (flash on AVR and
+ * ESP8266). The sizes are the sizeof() on the platform running the sketch.
+ */
+static void printTableSizes() {
+  SERIAL_PORT_MONITOR.print(F("Table of "));
+  SERIAL_PORT_MONITOR.print(LARGE_TABLE);
+  SERIAL_PORT_MONITOR.print(F(" commands: CommandHandler "));
+  SERIAL_PORT_MONITOR.print(sizeof(BENCH_COMMANDS[0]));
+  SERIAL_PORT_MONITOR.print(F("+"));
+  SERIAL_PORT_MONITOR.print(sizeof(COMMANDS[0]));
+  SERIAL_PORT_MONITOR.print(F(" bytes each, "));
+  SERIAL_PORT_MONITOR.print(sizeof(BENCH_COMMANDS) + sizeof(COMMANDS));
+  SERIAL_PORT_MONITOR.print(F(" bytes of RAM; ProgmemCommand "));
+  SERIAL_PORT_MONITOR.print(sizeof(PROGMEM_COMMANDS[0]));
+  SERIAL_PORT_MONITOR.print(F(" bytes each, "));
+  SERIAL_PORT_MONITOR.print(sizeof(PROGMEM_COMMANDS));
+  SERIAL_PORT_MONITOR.println(F(" bytes of PROGMEM"));
+}
+
+static const uint16_t NUM_IDLE_PASSES = 1000;
+
+static StreamProcessorCoroutine* const STREAM_PROCESSORS[] = {
+  &streamSmallSmall.getStreamProcessor(),
+  &streamSmallLarge.getStreamProcessor(),
+#if BENCH_LARGE_BUFFERS
+  &streamLargeSmall.getStreamProcessor(),
+  &streamLargeLarge.getStreamProcessor(),
+#endif
+};
+
+static const uint8_t NUM_STREAM_PROCESSORS =
+    sizeof(STREAM_PROCESSORS) / sizeof(STREAM_PROCESSORS[0]);
+
+/**
+ * Return the nanos per pass of a CoroutineScheduler over the idle Stream
+ * processors, which skips the suspended coroutines.
+ */
+static unsigned long measureIdlePasses() {
+  unsigned long startMicros = micros();
+  for (uint16_t i = 0; i < NUM_IDLE_PASSES; i++) {
+    for (uint8_t j = 0; j < NUM_STREAM_PROCESSORS; j++) {
+      StreamProcessorCoroutine* processor = STREAM_PROCESSORS[j];
+      if (! processor->isSuspended()) processor->runCoroutine();
+    }
+  }
+  unsigned long elapsedMicros = micros() - startMicros;
+  return (unsigned long) ((uint64_t) elapsedMicros * 1000 / NUM_IDLE_PASSES);
+}
+
+/**
+ * Compare the cost of the idle Stream processors when they poll
+ * Stream::available() on every pass, and when they suspend themselves until
+ * wakeup() is called.
+ */
+static void runIdleBenchmark() {
+  stream.setScript(0, 1);
+
+  unsigned long pollingNanos = measureIdlePasses();
+  for (uint8_t j = 0; j < NUM_STREAM_PROCESSORS; j++) {
+    STREAM_PROCESSORS[j]->setWakeupEnabled(true);
+  }
+  unsigned long wakeupNanos = measureIdlePasses();
+  for (uint8_t j = 0; j < NUM_STREAM_PROCESSORS; j++) {
+    STREAM_PROCESSORS[j]->setWakeupEnabled(false);
+  }
+
+  SERIAL_PORT_MONITOR.print(F("Idle pass of "));
+  SERIAL_PORT_MONITOR.print(NUM_STREAM_PROCESSORS);
+  SERIAL_PORT_MONITOR.print(F(" Stream processors: polling "));
+  SERIAL_PORT_MONITOR.print(pollingNanos);
+  SERIAL_PORT_MONITOR.print(F(" ns; wakeup "));
+  SERIAL_PORT_MONITOR.print(wakeupNanos);
+  SERIAL_PORT_MONITOR.println(F(" ns"));
+}
+
+static void runAll() {
+  printTableSizes();
+
+  SERIAL_PORT_MONITOR.println(
+      F("processor buf argv cmds cmds/sec ns/byte p50(us) p99(us)"));
+
+  runBenchmark(F("Direct"), directSmallSmall,
+      SMALL_BUF_SIZE, SMALL_ARGV_SIZE, SMALL_TABLE);
+  runBenchmark(F("Direct"), directSmallLarge,
+      SMALL_BUF_SIZE, SMALL_ARGV_SIZE, LARGE_TABLE);
+#if BENCH_LARGE_BUFFERS
+  runBenchmark(F("Direct"), directLargeSmall,
+      LARGE_BUF_SIZE, LARGE_ARGV_SIZE, SMALL_TABLE);
+  runBenchmark(F("Direct"), directLargeLarge,
+      LARGE_BUF_SIZE, LARGE_ARGV_SIZE, LARGE_TABLE);
+#endif
+
+  runBenchmark(F("Progmem"), progmemSmallSmall,
+      SMALL_BUF_SIZE, SMALL_ARGV_SIZE, SMALL_TABLE);
+  runBenchmark(F("Progmem"), progmemSmallLarge,
+      SMALL_BUF_SIZE, SMALL_ARGV_SIZE, LARGE_TABLE);
+
+  runBenchmark(F("Stream"), streamSmallSmall,
+      SMALL_BUF_SIZE, SMALL_ARGV_SIZE, SMALL_TABLE);
+  runBenchmark(F("Stream"), streamSmallLarge,
+      SMALL_BUF_SIZE, SMALL_ARGV_SIZE, LARGE_TABLE);
+#if BENCH_LARGE_BUFFERS
+  runBenchmark(F("Stream"), streamLargeSmall,
+      LARGE_BUF_SIZE, LARGE_ARGV_SIZE, SMALL_TABLE);
+  runBenchmark(F("Stream"), streamLargeLarge,
+      LARGE_BUF_SIZE, LARGE_ARGV_SIZE, LARGE_TABLE);
+#endif
+
+  runBenchmark(F("Channel"), channelSmallSmall,
+      SMALL_BUF_SIZE, SMALL_ARGV_SIZE, SMALL_TABLE);
+  runBenchmark(F("Channel"), channelSmallLarge,
+      SMALL_BUF_SIZE, SMALL_ARGV_SIZE, LARGE_TABLE);
+#if BENCH_LARGE_BUFFERS
+  runBenchmark(F("Channel"), channelLargeSmall,
+      LARGE_BUF_SIZE, LARGE_ARGV_SIZE, SMALL_TABLE);
+  runBenchmark(F("Channel"), channelLargeLarge,
+      LARGE_BUF_SIZE, LARGE_ARGV_SIZE, LARGE_TABLE);
+#endif
+
+  runIdleBenchmark();
+}
+
+//---------------------------------------------------------------------------
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000);
+#endif
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (!SERIAL_PORT_MONITOR); // micro/leonardo
+
+  runAll();
+
+#if defined(EPOXY_DUINO)
+  exit(0);
+#endif
+}
+
+void loop() {}
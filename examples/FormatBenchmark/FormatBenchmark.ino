@@ -0,0 +1,199 @@
+/*
+ * Benchmark of the AceUtils/cli/NumberFormat functions, compared to the
+ * equivalent Print::print() calls, for:
+ *
+ *  - decimal: an unsigned 32-bit value
+ *  - hex2: a byte as 2 hex digits with a leading zero
+ *  - hexdump: a row of 16 bytes, with the address and the ASCII columns
+ *  - fixed: a value scaled by 100, with 2 decimals (Print uses a float)
+ *
+ * The output is thrown away. On AVR processors, the results are printed in CPU
+ * cycles per value (derived from micros() and F_CPU). On other processors,
+ * including EpoxyDuino, they are printed in nanoseconds per value.
+ *
+ * Run on EpoxyDuino using 'make && ./FormatBenchmark.out', or upload to a
+ * microcontroller and read the results on the serial port.
+ */
+
+#include <Arduino.h>
+#include <AceUtils.h>
+#include <cli/cli.h> // from AceUtils
+
+using ace_utils::cli::NumberFormat;
+
+#if ! defined(SERIAL_PORT_MONITOR)
+  #define SERIAL_PORT_MONITOR Serial
+#endif
+
+//---------------------------------------------------------------------------
+// Test fixtures.
+//---------------------------------------------------------------------------
+
+/** A Print that throws away its output, but counts it. */
+class NullPrint: public Print {
+  public:
+    size_t write(uint8_t) override {
+      count++;
+      return 1;
+    }
+
+    size_t write(const uint8_t* /*buffer*/, size_t size) override {
+      count += size;
+      return size;
+    }
+
+    uint32_t count = 0;
+};
+
+static NullPrint nullPrint;
+
+static const uint16_t NUM_VALUES = 256;
+
+static uint32_t values[NUM_VALUES];
+
+/** Fill the values with a fixed pseudo-random sequence. */
+static void createValues() {
+  uint32_t x = 12345;
+  for (uint16_t i = 0; i < NUM_VALUES; i++) {
+    x = x * 1103515245 + 12345;
+    // Spread the magnitudes, so that short numbers are also measured.
+    values[i] = x >> (i % 24);
+  }
+}
+
+//---------------------------------------------------------------------------
+// Print baselines and NumberFormat equivalents.
+//---------------------------------------------------------------------------
+
+static void printDecimal(uint32_t value) {
+  nullPrint.print(value);
+}
+
+static void formatDecimal(uint32_t value) {
+  NumberFormat::printUint(nullPrint, value);
+}
+
+static void printHex2(uint32_t value) {
+  uint8_t b = value;
+  if (b < 0x10) nullPrint.print('0');
+  nullPrint.print(b, HEX);
+}
+
+static void formatHex2(uint32_t value) {
+  NumberFormat::printHex(nullPrint, (uint8_t) value, 2);
+}
+
+static void printHexDumpRow(uint32_t value) {
+  const uint8_t* data = (const uint8_t*) values;
+  uint16_t address = (value & 0x3F) * 16;
+  for (uint16_t a = 0x1000; a > 1; a >>= 4) {
+    if (address < a) nullPrint.print('0');
+  }
+  nullPrint.print(address, HEX);
+  nullPrint.print(F(": "));
+  for (uint8_t i = 0; i < 16; i++) {
+    uint8_t b = data[address + i];
+    if (b < 0x10) nullPrint.print('0');
+    nullPrint.print(b, HEX);
+    nullPrint.print(' ');
+  }
+  nullPrint.print(' ');
+  for (uint8_t i = 0; i < 16; i++) {
+    uint8_t c = data[address + i];
+    nullPrint.print((char) ((c >= ' ' && c <= '~') ? c : '.'));
+  }
+  nullPrint.println();
+}
+
+static void formatHexDumpRow(uint32_t value) {
+  const uint8_t* data = (const uint8_t*) values;
+  uint16_t address = (value & 0x3F) * 16;
+  NumberFormat::printHexDumpRow(nullPrint, address, data + address, 16);
+}
+
+static void printFixed(uint32_t value) {
+  nullPrint.print((int32_t) (value >> 8) / 100.0, 2);
+}
+
+static void formatFixed(uint32_t value) {
+  NumberFormat::printFixed(nullPrint, (int32_t) (value >> 8), 2);
+}
+
+//---------------------------------------------------------------------------
+// Benchmark runner.
+//---------------------------------------------------------------------------
+
+/**
+ * Return the time taken by 'format' for each value, in cycles on AVR, and in
+ * nanos elsewhere.
+ */
+static unsigned long measure(void (*format)(uint32_t)) {
+  unsigned long startMicros = micros();
+  for (uint16_t i = 0; i < NUM_VALUES; i++) {
+    format(values[i]);
+  }
+  unsigned long elapsedMicros = micros() - startMicros;
+#if defined(ARDUINO_ARCH_AVR)
+  return (unsigned long)
+      ((uint64_t) elapsedMicros * (F_CPU / 1000000) / NUM_VALUES);
+#else
+  return (unsigned long) ((uint64_t) elapsedMicros * 1000 / NUM_VALUES);
+#endif
+}
+
+static void runBenchmark(
+    const __FlashStringHelper* name,
+    void (*baseline)(uint32_t),
+    void (*format)(uint32_t)) {
+
+  unsigned long printTime = measure(baseline);
+  uint32_t printBytes = nullPrint.count;
+  nullPrint.count = 0;
+  unsigned long formatTime = measure(format);
+  uint32_t formatBytes = nullPrint.count;
+  nullPrint.count = 0;
+
+  SERIAL_PORT_MONITOR.print(name);
+  SERIAL_PORT_MONITOR.print(' ');
+  SERIAL_PORT_MONITOR.print(printTime);
+  SERIAL_PORT_MONITOR.print(' ');
+  SERIAL_PORT_MONITOR.print(formatTime);
+  // The outputs should have the same length.
+  if (printBytes != formatBytes) {
+    SERIAL_PORT_MONITOR.print(F(" (length mismatch)"));
+  }
+  SERIAL_PORT_MONITOR.println();
+}
+
+static void runAll() {
+  createValues();
+
+#if defined(ARDUINO_ARCH_AVR)
+  SERIAL_PORT_MONITOR.println(F("format Print(cycles) NumberFormat(cycles)"));
+#else
+  SERIAL_PORT_MONITOR.println(F("format Print(ns) NumberFormat(ns)"));
+#endif
+
+  runBenchmark(F("decimal"), printDecimal, formatDecimal);
+  runBenchmark(F("hex2"), printHex2, formatHex2);
+  runBenchmark(F("hexdump"), printHexDumpRow, formatHexDumpRow);
+  runBenchmark(F("fixed"), printFixed, formatFixed);
+}
+
+//---------------------------------------------------------------------------
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000);
+#endif
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (!SERIAL_PORT_MONITOR); // micro/leonardo
+
+  runAll();
+
+#if defined(EPOXY_DUINO)
+  exit(0);
+#endif
+}
+
+void loop() {}
@@ -15,6 +15,7 @@
  *  - `free` - print free memory
  *  - `echo [args ...]` - echo the arguments
  *  - `delay (on | off) millis` - set LED blink on or off delay
+ *  - `jitter [reset]` - print the histogram of the gaps between loop()
  */
 
 #include <Arduino.h>
@@ -26,6 +27,8 @@
 using ace_routine::CoroutineScheduler;
 using ace_utils::cli::CommandHandler;
 using ace_utils::cli::StreamProcessorManager;
+using ace_utils::cli::LoopJitter;
+using ace_utils::cli::JitterCommand;
 using ace_utils::freemem::freeMemory;
 
 // Every board except ESP32 defines SERIAL_PORT_MONITOR..
@@ -140,15 +143,20 @@ class DelayCommand: public CommandHandler {
     }
 };
 
+// Record the gaps between loop() iterations longer than 1 millisecond.
+LoopJitter loopJitter(1000);
+
 DelayCommand delayCommand;
 ListCommand listCommand;
 FreeCommand freeCommand;
 EchoCommand echoCommand;
+JitterCommand jitterCommand(loopJitter);
 static const CommandHandler* const COMMANDS[] = {
   &delayCommand,
   &listCommand,
   &freeCommand,
-  &echoCommand
+  &echoCommand,
+  &jitterCommand,
 };
 static const uint8_t NUM_COMMANDS = sizeof(COMMANDS) / sizeof(CommandHandler*);
 
@@ -174,9 +182,11 @@ void setup() {
   enableTerminalEcho();
 #endif
 
+  commandManager.getStreamProcessor().setLoopJitter(&loopJitter, "stream");
   CoroutineScheduler::setup();
 }
 
 void loop() {
+  loopJitter.tick();
   CoroutineScheduler::loop();
 }
@@ -0,0 +1,94 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_ARENA_COMMAND_HANDLER_H
+#define ACE_UTILS_CLI_ARENA_COMMAND_HANDLER_H
+
+#include "CommandHandler.h"
+#include "ScratchArena.h"
+
+namespace ace_utils {
+namespace cli {
+
+/**
+ * A CommandHandler which takes its temporary buffers from the ScratchArena of
+ * the CommandDispatcher, given to the processor manager using
+ * setScratchArena(). The subclass implements runWithArena() instead of run().
+ * The allocations are freed when runWithArena() returns, so they must not be
+ * kept for poll().
+ *
+ * Example usage:
+ *
+ * @code
+ * class HexCommand: public ArenaCommandHandler {
+ *   public:
+ *     HexCommand(): ArenaCommandHandler(F("hex"), F("string")) {}
+ *
+ *     void runWithArena(Print& printer, int argc, const char* const* argv,
+ *         ScratchArena& arena) const override {
+ *       char* buf = arena.allocate<char>(...);
+ *       if (buf == nullptr) {
+ *         printer.println(F("Error: Out of scratch memory"));
+ *         return;
+ *       }
+ *       ...
+ *     }
+ * };
+ *
+ * FixedScratchArena<128> scratchArena;
+ *
+ * void setup() {
+ *   commandManager.setScratchArena(&scratchArena);
+ * }
+ * @endcode
+ */
+class ArenaCommandHandler: public CommandHandler {
+  public:
+    /**
+     * Run the command with an empty arena. Called only if the command is run
+     * without a CommandDispatcher.
+     */
+    void run(Print& printer, int argc, const char* const* argv)
+        const final {
+      runWithArena(printer, argc, argv, ScratchArena::getEmpty());
+    }
+
+    void runWithArena(Print& printer, int argc, const char* const* argv,
+        ScratchArena& arena) const override = 0;
+
+  protected:
+    /** Constructor. Using C strings. */
+    ArenaCommandHandler(const char* name, const char* helpString):
+        CommandHandler(name, helpString) {}
+
+    /** Constructor. Using Flash strings. */
+    ArenaCommandHandler(const __FlashStringHelper* name,
+        const __FlashStringHelper* helpString):
+        CommandHandler(name, helpString) {}
+};
+
+} // cli
+} // ace_utils
+
+#endif
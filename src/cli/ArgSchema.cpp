@@ -0,0 +1,230 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdlib.h> // strtol(), strtod()
+#include <Arduino.h> // Print, F()
+#include "ArgSchema.h"
+
+namespace ace_utils {
+namespace cli {
+
+int8_t ArgSchema::parse(
+    Print& printer,
+    const ArgSpec* schema,
+    uint8_t numSpecs,
+    int argc,
+    const char* const* argv,
+    ArgValue* values,
+    uint8_t valuesSize) {
+  return parseArgs(printer, schema, numSpecs, argc, argv, nullptr, nullptr,
+      values, valuesSize);
+}
+
+int8_t ArgSchema::parseTyped(
+    Print& printer,
+    const ArgSpec* schema,
+    uint8_t numSpecs,
+    int argc,
+    const ArgValue* args,
+    const uint8_t* types,
+    ArgValue* values,
+    uint8_t valuesSize) {
+  return parseArgs(printer, schema, numSpecs, argc, nullptr, args, types,
+      values, valuesSize);
+}
+
+int8_t ArgSchema::parseArgs(
+    Print& printer,
+    const ArgSpec* schema,
+    uint8_t numSpecs,
+    int argc,
+    const char* const* argv,
+    const ArgValue* args,
+    const uint8_t* types,
+    ArgValue* values,
+    uint8_t valuesSize) {
+
+  uint8_t count = 0;
+  int t = 0;
+  for (uint8_t i = 0; i < numSpecs; i++) {
+    ArgSpec spec;
+    readSpec(spec, schema, i);
+
+    // An absent optional group means that the following groups are absent.
+    if ((spec.flags & ArgSpec::kFlagOptional) && t >= argc) break;
+
+    // A variadic argument consumes the rest of the tokens.
+    uint8_t numTokens = 1;
+    if (spec.flags & ArgSpec::kFlagVariadic) {
+      numTokens = argc - t;
+    } else if (t >= argc) {
+      printer.println(F("Error: Missing argument"));
+      return -1;
+    }
+
+    for (uint8_t n = 0; n < numTokens && count < valuesSize; n++, t++) {
+      bool isInt = (types != nullptr && types[t] == ArgSpec::kTypeInt);
+      const char* token = (types == nullptr) ? argv[t] : args[t].s;
+      bool valid = isInt
+          ? convertInt(spec, args[t].i, values[count])
+          : parseValue(spec, token, values[count]);
+      if (! valid) {
+        printer.print(F("Error: Invalid argument '"));
+        if (isInt) {
+          printer.print(args[t].i);
+        } else {
+          printer.print(token);
+        }
+        printer.println('\'');
+        return -1;
+      }
+      count++;
+    }
+  }
+
+  if (t < argc) {
+    printer.println(F("Error: Too many arguments"));
+    return -1;
+  }
+  return count;
+}
+
+bool ArgSchema::parseValue(
+    const ArgSpec& spec, const char* token, ArgValue& value) {
+  bool checkRange = (spec.minValue != 0 || spec.maxValue != 0);
+  char* end;
+
+  switch (spec.type) {
+    case ArgSpec::kTypeInt: {
+      long i = strtol(token, &end, 10);
+      if (end == token || *end != '\0') return false;
+      if (checkRange && (i < spec.minValue || i > spec.maxValue)) {
+        return false;
+      }
+      value.i = i;
+      return true;
+    }
+
+    case ArgSpec::kTypeFloat: {
+      double f = strtod(token, &end);
+      if (end == token || *end != '\0') return false;
+      if (checkRange && (f < spec.minValue || f > spec.maxValue)) {
+        return false;
+      }
+      value.f = f;
+      return true;
+    }
+
+    case ArgSpec::kTypeEnum: {
+      int16_t index = findChoice(spec.name, token);
+      if (index < 0) return false;
+      value.e = index;
+      return true;
+    }
+
+    default:
+      value.s = token;
+      return true;
+  }
+}
+
+bool ArgSchema::convertInt(const ArgSpec& spec, int32_t i, ArgValue& value) {
+  bool checkRange = (spec.minValue != 0 || spec.maxValue != 0);
+  if (checkRange && (i < spec.minValue || i > spec.maxValue)) return false;
+
+  if (spec.type == ArgSpec::kTypeInt) {
+    value.i = i;
+    return true;
+  } else if (spec.type == ArgSpec::kTypeFloat) {
+    value.f = i;
+    return true;
+  } else {
+    // An enum or a string is sent as a string.
+    return false;
+  }
+}
+
+int16_t ArgSchema::findChoice(const char* choices, const char* token) {
+  int16_t index = 0;
+  const char* p = choices;
+  while (true) {
+    const char* t = token;
+    char c;
+    while ((c = pgm_read_byte(p)) != '\0' && c != '|' && c == *t) {
+      p++;
+      t++;
+    }
+    if ((c == '\0' || c == '|') && *t == '\0') return index;
+
+    // Skip to the next choice.
+    while (c != '\0' && c != '|') {
+      p++;
+      c = pgm_read_byte(p);
+    }
+    if (c == '\0') return -1;
+    p++;
+    index++;
+  }
+}
+
+void ArgSchema::printUsage(
+    Print& printer, const ArgSpec* schema, uint8_t numSpecs) {
+  bool inGroup = false;
+  for (uint8_t i = 0; i < numSpecs; i++) {
+    ArgSpec spec;
+    readSpec(spec, schema, i);
+
+    if (spec.flags & ArgSpec::kFlagOptional) {
+      if (inGroup) printer.print(']');
+      if (i > 0) printer.print(' ');
+      printer.print('[');
+      inGroup = true;
+    } else if (i > 0) {
+      printer.print(' ');
+    }
+
+    if (spec.type == ArgSpec::kTypeEnum) {
+      // Print "on|off" as "(on | off)".
+      printer.print('(');
+      const char* p = spec.name;
+      char c;
+      while ((c = pgm_read_byte(p++)) != '\0') {
+        if (c == '|') {
+          printer.print(F(" | "));
+        } else {
+          printer.print(c);
+        }
+      }
+      printer.print(')');
+    } else {
+      printer.print((const __FlashStringHelper*) spec.name);
+    }
+
+    if (spec.flags & ArgSpec::kFlagVariadic) printer.print(F(" ..."));
+  }
+  if (inGroup) printer.print(']');
+}
+
+} // cli
+} // ace_utils
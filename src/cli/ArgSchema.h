@@ -0,0 +1,191 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_ARG_SCHEMA_H
+#define ACE_UTILS_CLI_ARG_SCHEMA_H
+
+#include <stdint.h>
+#include <Arduino.h> // PROGMEM, memcpy_P()
+
+class Print;
+
+namespace ace_utils {
+namespace cli {
+
+/**
+ * The specification of a single argument of a command, placed in PROGMEM as
+ * an array which forms the argument schema of the command. See ArgSchema and
+ * SchemaCommandHandler.
+ *
+ * An argument with the kFlagOptional flag starts an optional group, which
+ * extends until the next optional argument or the end of the schema. The
+ * arguments of a group must be given all together, or not at all. For
+ * example, the schema of `delay [(on | off) millis]` is:
+ *
+ * @code
+ * static const char DELAY_MODES[] PROGMEM = "on|off";
+ * static const char DELAY_MILLIS[] PROGMEM = "millis";
+ * static const ArgSpec DELAY_SCHEMA[] PROGMEM = {
+ *   {ArgSpec::kTypeEnum, ArgSpec::kFlagOptional, DELAY_MODES, 0, 0},
+ *   {ArgSpec::kTypeInt, 0, DELAY_MILLIS, 0, 10000},
+ * };
+ * @endcode
+ */
+struct ArgSpec {
+  /** An integer parsed with strtol(), stored in ArgValue::i. */
+  static uint8_t const kTypeInt = 0;
+
+  /** A floating point number parsed with strtod(), stored in ArgValue::f. */
+  static uint8_t const kTypeFloat = 1;
+
+  /**
+   * One of the choices in 'name' separated by '|', e.g. "on|off". The index
+   * of the choice is stored in ArgValue::e.
+   */
+  static uint8_t const kTypeEnum = 2;
+
+  /** Any string, stored in ArgValue::s. */
+  static uint8_t const kTypeString = 3;
+
+  /** This argument starts an optional group. */
+  static uint8_t const kFlagOptional = 0x01;
+
+  /**
+   * This argument accepts any number of tokens (including zero). Must be the
+   * last argument of the schema.
+   */
+  static uint8_t const kFlagVariadic = 0x02;
+
+  /** One of the kTypeXxx constants. */
+  uint8_t type;
+
+  /** A combination of the kFlagXxx constants. */
+  uint8_t flags;
+
+  /** Name in PROGMEM printed in the usage, or the choices of kTypeEnum. */
+  const char* name;
+
+  /**
+   * The range of valid values of kTypeInt and kTypeFloat, inclusive. The
+   * range is not checked if minValue and maxValue are both 0.
+   */
+  int32_t minValue;
+  int32_t maxValue;
+};
+
+/** The value of an argument parsed according to its ArgSpec. */
+union ArgValue {
+  int32_t i;
+  float f;
+  uint8_t e;
+  const char* s;
+};
+
+/**
+ * Functions which validate and convert the argv tokens of a command according
+ * to an array of ArgSpec in PROGMEM, and print the usage string generated
+ * from the same array.
+ */
+class ArgSchema {
+  public:
+    /**
+     * Parse the arguments in argv[0..argc-1] (not including the command name)
+     * into 'values'. Return the number of values filled in, or -1 if an
+     * argument is missing or invalid, or there are too many arguments, in
+     * which case an error message is printed to 'printer'. The usage line is
+     * not printed.
+     */
+    static int8_t parse(
+        Print& printer,
+        const ArgSpec* schema,
+        uint8_t numSpecs,
+        int argc,
+        const char* const* argv,
+        ArgValue* values,
+        uint8_t valuesSize);
+
+    /**
+     * Same as parse(), for the typed arguments of a binary request (see
+     * CommandHandler::runTyped()). The 'types' array holds the type of each
+     * of the 'argc' elements of 'args', either kTypeInt for a binary integer
+     * in ArgValue::i, or kTypeString for a token in ArgValue::s. An integer
+     * is accepted by a kTypeInt or kTypeFloat argument without being
+     * converted into text. A token is parsed in the same way as parse().
+     */
+    static int8_t parseTyped(
+        Print& printer,
+        const ArgSpec* schema,
+        uint8_t numSpecs,
+        int argc,
+        const ArgValue* args,
+        const uint8_t* types,
+        ArgValue* values,
+        uint8_t valuesSize);
+
+    /**
+     * Print the usage of the arguments (not including the command name),
+     * e.g. "[(on | off) millis]", generated from the schema.
+     */
+    static void printUsage(
+        Print& printer, const ArgSpec* schema, uint8_t numSpecs);
+
+  private:
+    /** Read the i'th ArgSpec from PROGMEM. */
+    static void readSpec(ArgSpec& spec, const ArgSpec* schema, uint8_t i) {
+      memcpy_P(&spec, &schema[i], sizeof(ArgSpec));
+    }
+
+    /**
+     * Implementation of parse() and parseTyped(). The arguments are the
+     * tokens in 'argv' if 'types' is null, otherwise the typed 'args'.
+     */
+    static int8_t parseArgs(
+        Print& printer,
+        const ArgSpec* schema,
+        uint8_t numSpecs,
+        int argc,
+        const char* const* argv,
+        const ArgValue* args,
+        const uint8_t* types,
+        ArgValue* values,
+        uint8_t valuesSize);
+
+    /** Parse a single token. Return false if the token is invalid. */
+    static bool parseValue(
+        const ArgSpec& spec, const char* token, ArgValue& value);
+
+    /** Convert a binary integer. Return false if the integer is invalid. */
+    static bool convertInt(const ArgSpec& spec, int32_t i, ArgValue& value);
+
+    /**
+     * Find 'token' in the '|' separated list of choices in PROGMEM. Return
+     * the index of the choice, or -1 if not found.
+     */
+    static int16_t findChoice(const char* choices, const char* token);
+};
+
+} // cli
+} // ace_utils
+
+#endif
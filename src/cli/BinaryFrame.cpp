@@ -0,0 +1,72 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <string.h> // memmove()
+#include <Arduino.h> // Print
+#include "BinaryFrame.h"
+
+namespace ace_utils {
+namespace cli {
+
+size_t BinaryFrame::encode(Print& printer, const uint8_t* data, uint8_t len) {
+  size_t n = 0;
+  uint8_t i = 0;
+  while (true) {
+    // A block holds up to 254 non-zero bytes, prefixed by its length + 1.
+    uint8_t start = i;
+    while (i < len && data[i] != 0 && i - start < 254) i++;
+    uint8_t blockLen = i - start;
+    n += printer.write((uint8_t) (blockLen + 1));
+    n += printer.write(data + start, blockLen);
+
+    // A block shorter than 254 stands for the zero which follows it. A full
+    // block does not, so the zero starts the next block.
+    if (blockLen < 254 && i < len) {
+      i++;
+      continue;
+    }
+    if (i >= len) break;
+  }
+  n += printer.write((uint8_t) 0);
+  return n;
+}
+
+int16_t BinaryFrame::decode(uint8_t* buffer, uint8_t len) {
+  uint8_t r = 0;
+  uint8_t w = 0;
+  while (r < len) {
+    uint8_t code = buffer[r++];
+    if (code == 0) return -1;
+    uint8_t blockLen = code - 1;
+    if (blockLen > len - r) return -1;
+    memmove(buffer + w, buffer + r, blockLen);
+    w += blockLen;
+    r += blockLen;
+    if (code != 0xFF && r < len) buffer[w++] = 0;
+  }
+  return w;
+}
+
+} // cli
+} // ace_utils
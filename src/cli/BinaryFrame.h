@@ -0,0 +1,91 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_BINARY_FRAME_H
+#define ACE_UTILS_CLI_BINARY_FRAME_H
+
+#include <stdint.h>
+#include <stddef.h> // size_t
+
+class Print;
+
+namespace ace_utils {
+namespace cli {
+
+/**
+ * Constants and COBS (Consistent Overhead Byte Stuffing) encoding functions
+ * of the binary frame protocol used by FrameProcessor. Each frame is COBS
+ * encoded, so that it contains no 0x00 byte, and is terminated by a 0x00.
+ *
+ * A request frame decodes into:
+ *
+ *  * reqId (1 byte): arbitrary id chosen by the host, echoed in the response
+ *  * cmdId (1 byte): index of the command in the CommandHandler array
+ *  * arguments: zero or more of
+ *      * kArgString, followed by a NUL-terminated string
+ *      * kArgInt32, followed by a 4-byte little-endian signed integer
+ *  * CRC16-CCITT (2 bytes, big-endian) of all the previous bytes
+ *
+ * A response frame decodes into:
+ *
+ *  * reqId (1 byte): the reqId of the request
+ *  * status (1 byte): one of the kStatusXxx constants
+ *  * output (0 or more bytes): the output of the command handler
+ *  * CRC16-CCITT (2 bytes, big-endian) of all the previous bytes
+ */
+class BinaryFrame {
+  public:
+    /** Argument type followed by a NUL-terminated string. */
+    static uint8_t const kArgString = 1;
+    /** Argument type followed by a 4-byte little-endian signed integer. */
+    static uint8_t const kArgInt32 = 2;
+
+    /** The command ran, and its entire output is in the response. */
+    static uint8_t const kStatusOk = 0;
+    /** The cmdId is not in the CommandHandler array. */
+    static uint8_t const kStatusUnknownCommand = 1;
+    /** The arguments are malformed, or there are too many of them. */
+    static uint8_t const kStatusBadArgs = 2;
+    /** The CRC of the request did not match. */
+    static uint8_t const kStatusCrcError = 3;
+    /** The command ran, but its output did not fit in the response. */
+    static uint8_t const kStatusTruncated = 4;
+
+    /**
+     * Write the COBS encoding of the given data to the printer, followed by
+     * the 0x00 frame delimiter. Return the number of bytes written.
+     */
+    static size_t encode(Print& printer, const uint8_t* data, uint8_t len);
+
+    /**
+     * Decode the COBS encoded frame in place, without its 0x00 delimiter.
+     * Return the length of the decoded data, or -1 if the frame is malformed.
+     */
+    static int16_t decode(uint8_t* buffer, uint8_t len);
+};
+
+} // cli
+} // ace_utils
+
+#endif
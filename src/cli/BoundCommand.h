@@ -0,0 +1,169 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_BOUND_COMMAND_H
+#define ACE_UTILS_CLI_BOUND_COMMAND_H
+
+#include "CommandDispatcher.h"
+
+namespace ace_utils {
+namespace cli {
+
+/**
+ * A command line which is tokenized and resolved to its CommandHandler (or
+ * ProgmemCommand) once, so that it can be invoked repeatedly from code (e.g. a
+ * scheduled maintenance task) without tokenizing the line and looking up the
+ * command each time. The tokens are copied into an internal buffer, so the
+ * original can be discarded.
+ *
+ * The line is tokenized by the constructor, but the command is looked up only
+ * by bind() or by the first invoke(). The constructor does not touch the
+ * CommandDispatcher, so a BoundCommand can be a global object, even if the
+ * COMMANDS of the dispatcher are initialized in another translation unit.
+ * Call bind() in setup() to check that the command exists.
+ *
+ * The invoke() method produces the same output as
+ * CommandDispatcher::runCommand() with the same line. The built-in `help`
+ * (and `stats`) commands, and a command which was not found when the line was
+ * bound, are passed to CommandDispatcher::runTokens() on each invocation,
+ * which prints the help text or the 'Unknown command' error.
+ *
+ * Example usage:
+ *
+ * @code
+ * BoundCommand<32, 4> resetCommand(commandDispatcher, "reset counters");
+ *
+ * void setup() {
+ *   ...
+ *   if (! resetCommand.bind()) {
+ *     Serial.println(F("Unknown command 'reset'"));
+ *   }
+ * }
+ *
+ * void runMaintenance() {
+ *   resetCommand.invoke(Serial);
+ * }
+ * @endcode
+ *
+ * @param BUF_SIZE Size of the copy of the tokens of the line, including a
+ *        NUL after each token. The tokens which do not fit are dropped.
+ * @param ARGV_SIZE Size of the argv token list.
+ */
+template<uint8_t BUF_SIZE, uint8_t ARGV_SIZE>
+class BoundCommand {
+  public:
+    /**
+     * Constructor. Copies and tokenizes the line, but does not look up the
+     * command.
+     *
+     * @param dispatcher the CommandDispatcher which resolves the command
+     * @param line the command line, e.g. "reset counters". Can be null, in
+     *        which case bind(line) must be called before invoke().
+     */
+    BoundCommand(const CommandDispatcher& dispatcher, const char* line):
+        mDispatcher(dispatcher)
+    {
+      setLine(line);
+    }
+
+    /**
+     * Look up the command of the current line. Return true if the command
+     * was found, or is a built-in command. The COMMANDS of the dispatcher
+     * must be fully initialized when this is called, so it should be called
+     * from setup() or later, not during static initialization.
+     */
+    bool bind() const {
+      mResolved = true;
+      mCommand = nullptr;
+      mProgmemCommand = nullptr;
+      if (mArgc == 0) return false;
+      if (CommandDispatcher::isBuiltinCommand(mArgv[0])) return true;
+
+      mCommand = mDispatcher.findCommand(mArgv[0]);
+      if (mCommand == nullptr) {
+        mProgmemCommand = mDispatcher.findProgmemCommand(mArgv[0]);
+      }
+      return mCommand != nullptr || mProgmemCommand != nullptr;
+    }
+
+    /** Replace the line with the given line, then call bind(). */
+    bool bind(const char* line) {
+      setLine(line);
+      return bind();
+    }
+
+    /**
+     * Run the bound command, and send the output to the 'printer'. Return
+     * the same value as CommandDispatcher::runCommand(). If the command is a
+     * long-running command, the caller must call CommandHandler::poll()
+     * until it returns true. Calls bind() first if it was not called.
+     */
+    const CommandHandler* invoke(Print& printer) const {
+      if (! mResolved) bind();
+      if (mCommand != nullptr) {
+        mDispatcher.runHandler(printer, mCommand, mArgc, mArgv);
+        return mCommand;
+      }
+      if (mProgmemCommand != nullptr) {
+        ProgmemCommand::readRun(mProgmemCommand)(printer, mArgc, mArgv);
+        return nullptr;
+      }
+      return mDispatcher.runTokens(printer, mArgc, mArgv);
+    }
+
+    /** Return the number of tokens of the bound line. */
+    uint8_t getArgc() const { return mArgc; }
+
+    /** Return the tokens of the bound line. */
+    const char* const* getArgv() const { return mArgv; }
+
+  private:
+    // Disable copy-constructor and assignment operator
+    BoundCommand(const BoundCommand&) = delete;
+    BoundCommand& operator=(const BoundCommand&) = delete;
+
+    /** Copy the tokens of the line, and forget the previous lookup. */
+    void setLine(const char* line) {
+      mResolved = false;
+      mArgc = 0;
+      if (line == nullptr) return;
+
+      mArgc = CommandDispatcher::copyTokens(
+          line, mArgv, ARGV_SIZE, mLine, BUF_SIZE);
+    }
+
+  private:
+    const CommandDispatcher& mDispatcher;
+    mutable const CommandHandler* mCommand = nullptr;
+    mutable const ProgmemCommand* mProgmemCommand = nullptr;
+    const char* mArgv[ARGV_SIZE];
+    char mLine[BUF_SIZE];
+    uint8_t mArgc = 0;
+    mutable bool mResolved = false;
+};
+
+} // cli
+} // ace_utils
+
+#endif
@@ -0,0 +1,231 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_BUFFERED_PRINT_H
+#define ACE_UTILS_CLI_BUFFERED_PRINT_H
+
+#include <stdint.h>
+#include <string.h> // memcpy()
+#include <Arduino.h> // Print, yield()
+
+namespace ace_utils {
+namespace cli {
+
+/**
+ * A Print adapter which collects the output of the CommandHandler into a
+ * fixed-size ring buffer, so that a long response (e.g. the `help` listing)
+ * does not block in the Serial TX buffer. The ring is drained into the
+ * underlying Print device by calling drain() periodically, either from the
+ * global loop() or using a BufferedPrintCoroutine. The drain() method writes
+ * only as many bytes as reported by `availableForWrite()` of the
+ * underlying device, so it never blocks. (The underlying device must
+ * implement availableForWrite(), as HardwareSerial does.)
+ *
+ * The `policy` parameter selects what happens when the ring is full:
+ *
+ *  * kPolicyBlock: write the pending bytes to the underlying device using a
+ *    blocking write(), like the unbuffered Print.
+ *  * kPolicyYield: call drain() in a loop, calling the Arduino `yield()`
+ *    function until the device has room. This allows background tasks of the
+ *    board (e.g. WiFi on ESP8266) to run while waiting. The default
+ *    Print::availableForWrite() always returns 0, so if the device reports no
+ *    room for kMaxYields passes, the pending bytes are written using a
+ *    blocking write() instead.
+ *  * kPolicyTruncate: discard the extra bytes, and count them in
+ *    getNumTruncated().
+ */
+class BufferedPrint: public Print {
+  public:
+    static uint8_t const kPolicyBlock = 0;
+    static uint8_t const kPolicyYield = 1;
+    static uint8_t const kPolicyTruncate = 2;
+
+    /**
+     * Number of calls to yield() by kPolicyYield before falling back to a
+     * blocking write().
+     */
+    static uint8_t const kMaxYields = 255;
+
+    /**
+     * Constructor.
+     *
+     * @param output the underlying Print device, usually the global Serial
+     * @param buffer storage for the ring buffer
+     * @param bufferSize size of the ring buffer
+     * @param policy one of kPolicyBlock, kPolicyYield, kPolicyTruncate
+     */
+    BufferedPrint(
+        Print& output,
+        char* buffer,
+        uint16_t bufferSize,
+        uint8_t policy = kPolicyBlock
+    ) :
+        mOutput(output),
+        mBuf(buffer),
+        mBufSize(bufferSize),
+        mPolicy(policy)
+    {}
+
+    size_t write(uint8_t c) override {
+      if (mUsed >= mBufSize && ! makeRoom()) {
+        mNumTruncated++;
+        return 0;
+      }
+      mBuf[mHead] = c;
+      mHead = nextIndex(mHead, 1);
+      addUsed(1);
+      return 1;
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) override {
+      size_t n = 0;
+      while (n < size) {
+        if (mUsed >= mBufSize && ! makeRoom()) {
+          mNumTruncated += size - n;
+          break;
+        }
+
+        // Copy the largest contiguous chunk which fits.
+        uint16_t chunk = mBufSize - mHead;
+        uint16_t room = mBufSize - mUsed;
+        if (chunk > room) chunk = room;
+        if (chunk > size - n) chunk = size - n;
+        memcpy(mBuf + mHead, buffer + n, chunk);
+        mHead = nextIndex(mHead, chunk);
+        addUsed(chunk);
+        n += chunk;
+      }
+      return n;
+    }
+
+    using Print::write;
+
+    /** Return the free space in the ring buffer. */
+    int availableForWrite() override { return mBufSize - mUsed; }
+
+    /**
+     * Write as many pending bytes as the underlying device can accept
+     * without blocking. Return the number of bytes written.
+     */
+    uint16_t drain() {
+      int room = mOutput.availableForWrite();
+      uint16_t n = 0;
+      while (room > 0 && mUsed > 0) {
+        uint16_t chunk = contiguousUsed();
+        if (chunk > (uint16_t) room) chunk = room;
+        uint16_t written = writeOutput(chunk);
+        if (written == 0) break;
+        room -= written;
+        n += written;
+      }
+      return n;
+    }
+
+    /** Write all pending bytes to the underlying device, blocking if needed. */
+    void drainAll() {
+      while (mUsed > 0) {
+        if (writeOutput(contiguousUsed()) == 0) break;
+      }
+    }
+
+    /** Return true if there are no pending bytes. */
+    bool isEmpty() const { return mUsed == 0; }
+
+    /** Return the number of pending bytes. */
+    uint16_t getNumPending() const { return mUsed; }
+
+    /** Return the maximum number of pending bytes at any time. */
+    uint16_t getMaxPending() const { return mMaxUsed; }
+
+    /** Return the number of bytes discarded by kPolicyTruncate. */
+    uint32_t getNumTruncated() const { return mNumTruncated; }
+
+  private:
+    // Disable copy-constructor and assignment operator
+    BufferedPrint(const BufferedPrint&) = delete;
+    BufferedPrint& operator=(const BufferedPrint&) = delete;
+
+    /**
+     * Free some space in a full ring according to the policy. Return false
+     * if the bytes should be discarded.
+     */
+    bool makeRoom() {
+      if (mPolicy == kPolicyBlock) {
+        writeOutput(contiguousUsed());
+      } else if (mPolicy == kPolicyYield) {
+        for (uint8_t i = 0; drain() == 0; i++) {
+          if (i == kMaxYields) {
+            // The device does not implement availableForWrite(), or is
+            // stuck. Fall back to kPolicyBlock.
+            writeOutput(contiguousUsed());
+            break;
+          }
+          yield();
+        }
+      }
+      return mUsed < mBufSize;
+    }
+
+    /** Write the next 'count' pending bytes, return the number written. */
+    uint16_t writeOutput(uint16_t count) {
+      uint16_t written = mOutput.write(
+          (const uint8_t*) mBuf + mTail, count);
+      mTail = nextIndex(mTail, written);
+      mUsed -= written;
+      return written;
+    }
+
+    /** Number of pending bytes which can be read without wrapping around. */
+    uint16_t contiguousUsed() const {
+      uint16_t chunk = mBufSize - mTail;
+      return (chunk < mUsed) ? chunk : mUsed;
+    }
+
+    uint16_t nextIndex(uint16_t index, uint16_t count) const {
+      index += count;
+      return (index >= mBufSize) ? index - mBufSize : index;
+    }
+
+    void addUsed(uint16_t count) {
+      mUsed += count;
+      if (mUsed > mMaxUsed) mMaxUsed = mUsed;
+    }
+
+  private:
+    Print& mOutput;
+    char* const mBuf;
+    uint16_t const mBufSize;
+    uint8_t const mPolicy;
+
+    uint16_t mHead = 0;
+    uint16_t mTail = 0;
+    uint16_t mUsed = 0;
+    uint16_t mMaxUsed = 0;
+    uint32_t mNumTruncated = 0;
+};
+
+} // cli
+} // ace_utils
+
+#endif
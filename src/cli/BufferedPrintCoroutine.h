@@ -0,0 +1,65 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_BUFFERED_PRINT_COROUTINE_H
+#define ACE_UTILS_CLI_BUFFERED_PRINT_COROUTINE_H
+
+#include <AceRoutine.h>
+#include "BufferedPrint.h"
+
+namespace ace_utils {
+namespace cli {
+
+/**
+ * A coroutine that drains a BufferedPrint into its underlying Print device,
+ * a little at a time, without blocking the other coroutines.
+ */
+class BufferedPrintCoroutine: public ace_routine::Coroutine {
+  public:
+    /** Constructor. */
+    BufferedPrintCoroutine(BufferedPrint& bufferedPrint):
+        mBufferedPrint(bufferedPrint)
+    {}
+
+    int runCoroutine() override {
+      COROUTINE_LOOP() {
+        COROUTINE_AWAIT(! mBufferedPrint.isEmpty());
+        mBufferedPrint.drain();
+        COROUTINE_YIELD();
+      }
+    }
+
+  private:
+    // Disable copy-constructor and assignment operator
+    BufferedPrintCoroutine(const BufferedPrintCoroutine&) = delete;
+    BufferedPrintCoroutine& operator=(const BufferedPrintCoroutine&) = delete;
+
+  private:
+    BufferedPrint& mBufferedPrint;
+};
+
+} // cli
+} // ace_utils
+
+#endif
@@ -25,6 +25,7 @@ SOFTWARE.
 #include <Arduino.h> // Print
 #include "ChannelProcessorCoroutine.h"
 #include "CommandDispatcher.h"
+#include "LoopJitter.h"
 
 namespace ace_utils {
 namespace cli {
@@ -38,17 +39,28 @@ int ChannelProcessorCoroutine::runCoroutine() {
     COROUTINE_CHANNEL_READ(mChannel, input);
 
     if (input.status == InputLine::kStatusOverflow) {
+      mCommandDispatcher.recordOverflow();
       printLineError(input.line, input.status);
       continue;
     }
 
-    if (mPrompt != nullptr) {
-      mPrinter.print(input.line); // line includes the \n
+    markBusy();
+    mActiveCommand = mCommandDispatcher.runCommand(mPrinter, input.line);
+    if (mActiveCommand != nullptr) {
+      COROUTINE_AWAIT(pollActiveCommand());
     }
-    mCommandDispatcher.runCommand(mPrinter, input.line);
   }
 }
 
+void ChannelProcessorCoroutine::markBusy() {
+  if (mLoopJitter) mLoopJitter->markBusy(mJitterTag);
+}
+
+bool ChannelProcessorCoroutine::pollActiveCommand() {
+  markBusy();
+  return mCommandDispatcher.pollHandler(mPrinter, mActiveCommand);
+}
+
 void ChannelProcessorCoroutine::printLineError(
     const char* line, uint8_t statusCode) const {
   if (statusCode == InputLine::kStatusOverflow) {
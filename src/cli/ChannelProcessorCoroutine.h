@@ -35,11 +35,14 @@ namespace ace_utils {
 namespace cli {
 
 class CommandDispatcher;
+class CommandHandler;
+class LoopJitter;
 
 /**
  * A coroutine that reads lines from a Channel (e.g. written by
  * StreamReaderCoroutine), then sends the command to the CommandDispatcher for
- * processing.
+ * processing. A long-running command (see CommandHandler::poll()) is awaited
+ * before the next line is read from the Channel.
  */
 class ChannelProcessorCoroutine: public ace_routine::Coroutine {
   public:
@@ -66,6 +69,16 @@ class ChannelProcessorCoroutine: public ace_routine::Coroutine {
 
     int runCoroutine() override;
 
+    /**
+     * Call LoopJitter::markBusy() with the given tag whenever a command is
+     * run, so that the outliers of the loop gap can be attributed to this
+     * processor. Pass nullptr to disable.
+     */
+    void setLoopJitter(LoopJitter* loopJitter, const char* tag) {
+      mLoopJitter = loopJitter;
+      mJitterTag = tag;
+    }
+
     /** Return the ChannelProcessorCoroutine. VisibleForTesting. */
     const CommandDispatcher& getDispatcher() const {
       return mCommandDispatcher;
@@ -79,11 +92,18 @@ class ChannelProcessorCoroutine: public ace_routine::Coroutine {
 
     void printLineError(const char* line, uint8_t statusCode) const;
 
+    void markBusy();
+
+    bool pollActiveCommand();
+
   private:
     ace_routine::Channel<InputLine>& mChannel;
     const CommandDispatcher& mCommandDispatcher;
     Print& mPrinter;
     const char* const mPrompt;
+    const CommandHandler* mActiveCommand = nullptr;
+    LoopJitter* mLoopJitter = nullptr;
+    const char* mJitterTag = nullptr;
 };
 
 } // cli
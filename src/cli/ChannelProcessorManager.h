@@ -102,7 +102,8 @@ class ChannelProcessorManager {
         const char* prompt = nullptr
     ) :
         mStreamReader(mChannel, stream, mLineBuffer, BUF_SIZE),
-        mCommandDispatcher(commands, numCommands, mArgv, ARGV_SIZE),
+        mCommandDispatcher(commands, numCommands, mArgv, ARGV_SIZE,
+            nullptr /*sortedIndex*/, mTokens, BUF_SIZE),
         mChannelProcessor(mChannel, mCommandDispatcher, printer, prompt)
     {}
 
@@ -116,6 +117,22 @@ class ChannelProcessorManager {
       return mChannelProcessor;
     }
 
+    /**
+     * Return the underlying CommandDispatcher, e.g. to create a BoundCommand
+     * or to give it to a WatchManager.
+     */
+    const CommandDispatcher& getCommandDispatcher() const {
+      return mCommandDispatcher;
+    }
+
+    /**
+     * Give the ScratchArena to the commands, see
+     * CommandDispatcher::setScratchArena().
+     */
+    void setScratchArena(ScratchArena* arena) {
+      mCommandDispatcher.setScratchArena(arena);
+    }
+
   private:
     // Disable copy-constructor and assignment operator
     ChannelProcessorManager (const ChannelProcessorManager &) = delete;
@@ -129,6 +146,7 @@ class ChannelProcessorManager {
     ChannelProcessorCoroutine mChannelProcessor;
     char mLineBuffer[BUF_SIZE];
     const char* mArgv[ARGV_SIZE];
+    char mTokens[BUF_SIZE];
 };
 
 } // cli
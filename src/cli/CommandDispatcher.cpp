@@ -34,8 +34,52 @@ SOFTWARE.
 namespace ace_utils {
 namespace cli {
 
-// Same whitespace characters used by isspace() in the standard C99 library.
-const char CommandDispatcher::DELIMS[] = " \f\r\n\t\v";
+// The delimiters are the same whitespace characters used by isspace() in the
+// standard C99 library. See isDelim().
+
+uint8_t CommandDispatcher::tokenizeSpans(
+    const char* line, TokenSpan* spans, uint8_t spansSize) {
+  uint8_t count = 0;
+  const char* start;
+  const char* end = line;
+  while (count < spansSize && (start = nextToken(end, &end)) != nullptr) {
+    spans[count].offset = start - line;
+    spans[count].length = end - start;
+    count++;
+  }
+  return count;
+}
+
+uint8_t CommandDispatcher::copyTokens(const char* line, const char** argv,
+    uint8_t argvSize, char* tokens, line_size_t tokensSize) {
+  uint8_t argc = 0;
+  line_size_t used = 0;
+  const char* start;
+  const char* end = line;
+  while (argc < argvSize && (start = nextToken(end, &end)) != nullptr) {
+    size_t len = end - start;
+    if (used + len + 1 > tokensSize) break;
+    memcpy(tokens + used, start, len);
+    tokens[used + len] = '\0';
+    argv[argc++] = tokens + used;
+    used += len + 1;
+  }
+  return argc;
+}
+
+uint8_t CommandDispatcher::terminateTokens(
+    char* line, const char** argv, uint8_t argvSize) {
+  uint8_t argc = 0;
+  const char* start;
+  const char* end = line;
+  while (argc < argvSize && (start = nextToken(end, &end)) != nullptr) {
+    argv[argc++] = start;
+    if (*end == '\0') break;
+    *const_cast<char*>(end) = '\0';
+    end++;
+  }
+  return argc;
+}
 
 void CommandDispatcher::helpCommandHandler(
     Print& printer, int argc, const char* const* argv) const {
@@ -48,6 +92,13 @@ void CommandDispatcher::helpCommandHandler(
       return;
     }
 
+  #if ACE_UTILS_CLI_ENABLE_STATS
+    if (strcmp(cmd, "stats") == 0) {
+      printer.println(F("Usage: stats"));
+      return;
+    }
+  #endif
+
     bool found = helpSpecific(printer, cmd);
     if (found) return;
     printer.print(F("Unknown command: '"));
@@ -56,11 +107,22 @@ void CommandDispatcher::helpCommandHandler(
   } else {
     printer.println(F("Commands:"));
     printer.println(F("  help [command]"));
+  #if ACE_UTILS_CLI_ENABLE_STATS
+    printer.println(F("  stats"));
+  #endif
     helpAll(printer);
   }
 }
 
 void CommandDispatcher::helpAll(Print& printer) const {
+  if (mProgmemCommands != nullptr) {
+    for (uint8_t i = 0; i < mNumCommands; i++) {
+      printer.print("  ");
+      printHelp(printer, &mProgmemCommands[i]);
+    }
+    return;
+  }
+
   for (uint8_t i = 0; i < mNumCommands; i++) {
     const CommandHandler* command = mCommands[i];
     printer.print("  ");
@@ -69,6 +131,14 @@ void CommandDispatcher::helpAll(Print& printer) const {
 }
 
 bool CommandDispatcher::helpSpecific(Print& printer, const char* cmd) const {
+  if (mProgmemCommands != nullptr) {
+    const ProgmemCommand* entry = findProgmemCommand(cmd);
+    if (entry == nullptr) return false;
+    printer.print(F("Usage: "));
+    printHelp(printer, entry);
+    return true;
+  }
+
   const CommandHandler* command = findCommand(cmd);
   if (command != nullptr) {
     printer.print(F("Usage: "));
@@ -80,43 +150,267 @@ bool CommandDispatcher::helpSpecific(Print& printer, const char* cmd) const {
 
 void CommandDispatcher::printHelp(
     Print& printer, const CommandHandler* command) {
-  command->getName().printTo(printer);
-  if (!command->getHelpString().isNull()) {
+  command->printUsage(printer);
+  printer.println();
+}
+
+void CommandDispatcher::printHelp(
+    Print& printer, const ProgmemCommand* entry) {
+  printer.print(ProgmemCommand::readName(entry));
+  const __FlashStringHelper* helpString = ProgmemCommand::readHelpString(entry);
+  if (helpString != nullptr) {
     printer.print(' ');
-    command->getHelpString().printTo(printer);
-    printer.println();
+    printer.print(helpString);
+  }
+  printer.println();
+}
+
+const CommandHandler* CommandDispatcher::runCommand(
+    Print& printer, char* line) const {
+  // Tokenize the line into the argv slots and token bytes which are not used
+  // by an outer command, if this is a nested call.
+  uint8_t argvUsed = mArgvUsed;
+  line_size_t tokensUsed = mTokensUsed;
+  const char** argv = mArgv + argvUsed;
+  uint8_t argc;
+  if (mTokens != nullptr) {
+    argc = copyTokens(line, argv, mArgvSize - argvUsed,
+        mTokens + tokensUsed, mTokensSize - tokensUsed);
+    if (argc > 0) {
+      const char* last = argv[argc - 1];
+      mTokensUsed = (last + strlen(last) + 1) - mTokens;
+    }
   } else {
-    printer.println();
+    argc = terminateTokens(line, argv, mArgvSize - argvUsed);
   }
+  if (argc == 0) return nullptr;
+
+  mArgvUsed = argvUsed + argc;
+  const CommandHandler* command = runTokens(printer, argc, argv);
+  mArgvUsed = argvUsed;
+  mTokensUsed = tokensUsed;
+  return command;
 }
 
-void CommandDispatcher::runCommand(Print& printer, char* line) const {
-  // Tokenize the line.
-  int argc = tokenize(line, mArgv, mArgvSize);
-  if (argc == 0) return;
-  const char* cmd = mArgv[0];
+const CommandHandler* CommandDispatcher::runTokens(
+    Print& printer, int argc, const char* const* argv) const {
+  if (argc == 0) return nullptr;
+  const char* cmd = argv[0];
 
-  // Handle the built-in 'help' command.
   if (strcmp(cmd, "help") == 0) {
-    helpCommandHandler(printer, argc, mArgv);
+    // Handle the built-in 'help' command.
+    helpCommandHandler(printer, argc, argv);
+    return nullptr;
+#if ACE_UTILS_CLI_ENABLE_STATS
+  } else if (strcmp(cmd, "stats") == 0) {
+    // Handle the built-in 'stats' command.
+    statsCommandHandler(printer);
+    return nullptr;
+#endif
+  } else {
+    return findAndRunCommand(printer, cmd, argc, argv);
+  }
+}
+
+const CommandHandler* CommandDispatcher::findCommand(const char* cmd) const {
+  if (mCommands == nullptr) return nullptr;
+  initLookup();
+  ace_common::FCString target(cmd);
+
+  if (mLookupMode == kLookupLinear) {
+    for (uint8_t i = 0; i < mNumCommands; i++) {
+      const CommandHandler* command = mCommands[i];
+      if (command->getName().compareTo(target) == 0) {
+        return command;
+      }
+    }
+    return nullptr;
+  }
+
+  // Binary search, through the mSortedIndex if it exists.
+  uint8_t low = 0;
+  uint8_t high = mNumCommands;
+  while (low < high) {
+    uint8_t mid = low + (high - low) / 2;
+    const CommandHandler* command = sortedCommandAt(mid);
+    int compare = command->getName().compareTo(target);
+    if (compare == 0) return command;
+    if (compare < 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return nullptr;
+}
+
+const ProgmemCommand* CommandDispatcher::findProgmemCommand(
+    const char* cmd) const {
+  if (mProgmemCommands == nullptr) return nullptr;
+  for (uint8_t i = 0; i < mNumCommands; i++) {
+    const ProgmemCommand* entry = &mProgmemCommands[i];
+    if (strcmp_P(cmd, (const char*) ProgmemCommand::readName(entry)) == 0) {
+      return entry;
+    }
+  }
+  return nullptr;
+}
+
+void CommandDispatcher::selectLookup() const {
+  if (mCommands == nullptr) {
+    mLookupMode = kLookupLinear;
     return;
   }
 
-  findAndRunCommand(printer, cmd, argc, mArgv);
+  if (mSortedIndex != nullptr) {
+    // Insertion sort. The number of commands is small, and this is done only
+    // once, so the O(N^2) is not a problem, and it uses less flash than
+    // anything fancier.
+    for (uint8_t i = 0; i < mNumCommands; i++) {
+      uint8_t current = i;
+      uint8_t j = i;
+      while (j > 0 && compareNames(
+          mCommands[mSortedIndex[j - 1]], mCommands[current]) > 0) {
+        mSortedIndex[j] = mSortedIndex[j - 1];
+        j--;
+      }
+      mSortedIndex[j] = current;
+    }
+    mLookupMode = kLookupIndex;
+    return;
+  }
+
+  for (uint8_t i = 1; i < mNumCommands; i++) {
+    if (compareNames(mCommands[i - 1], mCommands[i]) > 0) {
+      mLookupMode = kLookupLinear;
+      return;
+    }
+  }
+  mLookupMode = kLookupSorted;
 }
 
-void CommandDispatcher::findAndRunCommand(
+const CommandHandler* CommandDispatcher::findAndRunCommand(
     Print& printer, const char* cmd, int argc, const char* const* argv) const {
+  if (mProgmemCommands != nullptr) {
+    const ProgmemCommand* entry = findProgmemCommand(cmd);
+    if (entry != nullptr) {
+      ProgmemCommand::readRun(entry)(printer, argc, argv);
+      return nullptr;
+    }
+  }
+
   const CommandHandler* command = findCommand(cmd);
   if (command != nullptr) {
-    command->run(printer, argc, argv);
-    return;
+    runHandler(printer, command, argc, argv);
+    return command;
   }
 
+  recordUnknownCommand();
   printer.print(F("Unknown command: '"));
   printer.print(cmd);
   printer.println('\'');
+  return nullptr;
+}
+
+void CommandDispatcher::runHandler(Print& printer,
+    const CommandHandler* command, int argc, const char* const* argv) const {
+  ScratchArena& arena =
+      (mScratchArena != nullptr) ? *mScratchArena : ScratchArena::getEmpty();
+  mDepth++;
+#if ACE_UTILS_CLI_ENABLE_STATS
+  CountingPrint countingPrint(printer);
+  uint32_t startMicros = micros();
+  command->runWithArena(countingPrint, argc, argv, arena);
+  command->recordRun(micros() - startMicros, countingPrint.getCount());
+#else
+  command->runWithArena(printer, argc, argv, arena);
+#endif
+  mDepth--;
+  // A nested command must not free the buffers of the outer command.
+  if (mDepth == 0) arena.reset();
+}
+
+bool CommandDispatcher::runTypedHandler(Print& printer,
+    const CommandHandler* command, uint8_t numArgs, const ArgValue* args,
+    const uint8_t* types) const {
+  mDepth++;
+#if ACE_UTILS_CLI_ENABLE_STATS
+  CountingPrint countingPrint(printer);
+  uint32_t startMicros = micros();
+  bool handled = command->runTyped(countingPrint, numArgs, args, types);
+  if (handled) {
+    command->recordRun(micros() - startMicros, countingPrint.getCount());
+  }
+#else
+  bool handled = command->runTyped(printer, numArgs, args, types);
+#endif
+  mDepth--;
+  if (handled && mDepth == 0 && mScratchArena != nullptr) {
+    mScratchArena->reset();
+  }
+  return handled;
+}
+
+bool CommandDispatcher::pollHandler(
+    Print& printer, const CommandHandler* command) const {
+#if ACE_UTILS_CLI_ENABLE_STATS
+  CountingPrint countingPrint(printer);
+  uint32_t startMicros = micros();
+  bool done = command->poll(countingPrint);
+  command->recordWork(micros() - startMicros, countingPrint.getCount());
+  return done;
+#else
+  return command->poll(printer);
+#endif
 }
 
+void CommandDispatcher::payloadHandler(Print& printer,
+    const CommandHandler* command, const char* data, uint8_t len) const {
+#if ACE_UTILS_CLI_ENABLE_STATS
+  CountingPrint countingPrint(printer);
+  uint32_t startMicros = micros();
+  command->receivePayload(countingPrint, data, len);
+  command->recordWork(micros() - startMicros, countingPrint.getCount());
+#else
+  command->receivePayload(printer, data, len);
+#endif
+}
+
+#if ACE_UTILS_CLI_ENABLE_STATS
+
+void CommandDispatcher::statsCommandHandler(Print& printer) const {
+  printer.println(F("Commands:"));
+  // The ProgmemCommand entries are read-only, so they have no statistics.
+  uint8_t numHandlers = (mCommands != nullptr) ? mNumCommands : 0;
+  for (uint8_t i = 0; i < numHandlers; i++) {
+    const CommandHandler* command = mCommands[i];
+    const CommandStats& stats = command->getStats();
+    printer.print(F("  "));
+    command->getName().printTo(printer);
+    printer.print(F(": count="));
+    printer.print(stats.count);
+    printer.print(F("; total="));
+    printer.print(stats.totalMicros);
+    printer.print(F("us; max="));
+    printer.print(stats.maxMicros);
+    printer.print(F("us; bytes="));
+    printer.println(stats.bytesWritten);
+  }
+  printer.print(F("Unknown: "));
+  printer.println(mNumUnknownCommands);
+  printer.print(F("Overflows: "));
+  printer.println(mNumOverflows);
+  if (mScratchArena != nullptr) {
+    printer.print(F("Scratch: peak="));
+    printer.print(mScratchArena->getPeakUsed());
+    printer.print(F("; size="));
+    printer.print(mScratchArena->getSize());
+    printer.print(F("; failures="));
+    printer.println(mScratchArena->getNumFailures());
+  }
+}
+
+#endif
+
 } // cli
 } // ace_utils
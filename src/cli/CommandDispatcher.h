@@ -25,7 +25,11 @@ SOFTWARE.
 #ifndef ACE_UTILS_CLI_COMMAND_DISPATCHER_H
 #define ACE_UTILS_CLI_COMMAND_DISPATCHER_H
 
+#include <string.h> // strcmp(), strlen(), memcpy()
 #include "CommandHandler.h"
+#include "ProgmemCommand.h"
+#include "ScratchArena.h"
+#include "TokenSpan.h"
 
 class Print;
 class __FlashStringHelper;
@@ -52,67 +56,279 @@ class CommandDispatcher {
     /**
      * Constructor.
      *
+     * The command lookup in findCommand() selects one of 3 strategies:
+     *
+     *  * If `sortedIndex` is given, it is filled with the indexes of
+     *    `commands` sorted by name, and a binary search is performed through
+     *    that index. The order of `commands` is preserved for the `help`
+     *    listing.
+     *  * If `commands` is already sorted by name (e.g. because the array was
+     *    written in alphabetical order in the source code), a binary search is
+     *    performed directly on `commands` without consuming any extra RAM.
+     *  * Otherwise, a linear scan is performed.
+     *
+     * The sortedness check and the sorting of `sortedIndex` are performed
+     * lazily on the first call to findCommand(), to avoid depending on the
+     * static initialization order of the CommandHandler objects, which may be
+     * defined in a different translation unit.
+     *
      * @param commands Array of CommandHandler pointers.
      * @param numCommands number of commands.
      * @param argv Array of (const char*) that will be used to hold the word
      *        tokens of a command line string.
      * @param argvSize The size of the argv array. Tokens which are beyond this
      *        limit will be silently dropped.
+     * @param sortedIndex Optional array of `numCommands` elements which will
+     *        hold the sorted index of `commands`. If null, no index is used.
+     * @param tokens Optional buffer which will hold a NUL-terminated copy of
+     *        each argv token, so that runCommand() does not modify the line.
+     *        It should be as large as the line buffer of the processor. If
+     *        null, the tokens are NUL-terminated in place, and the line is
+     *        left tokenized, as it was in previous versions.
+     * @param tokensSize The size of the `tokens` buffer.
      */
     CommandDispatcher(
         const CommandHandler* const* commands,
         uint8_t numCommands,
         const char** argv,
-        uint8_t argvSize
+        uint8_t argvSize,
+        uint8_t* sortedIndex = nullptr,
+        char* tokens = nullptr,
+        line_size_t tokensSize = 0
     ) :
         mCommands(commands),
         mNumCommands(numCommands),
         mArgv(argv),
-        mArgvSize(argvSize)
+        mArgvSize(argvSize),
+        mSortedIndex(sortedIndex),
+        mTokens(tokens),
+        mTokensSize(tokensSize)
+    {}
+
+    /**
+     * Constructor using a table of ProgmemCommand entries in flash memory
+     * instead of an array of CommandHandler pointers. The entries are scanned
+     * linearly by findProgmemCommand(), and the help listing is printed in
+     * the order of the table.
+     *
+     * @param progmemCommands Array of ProgmemCommand in PROGMEM.
+     * @param numCommands number of commands.
+     * @param argv Array of (const char*) that will be used to hold the word
+     *        tokens of a command line string.
+     * @param argvSize The size of the argv array.
+     * @param tokens Optional buffer for the copy of the argv tokens, see the
+     *        other constructor.
+     * @param tokensSize The size of the `tokens` buffer.
+     */
+    CommandDispatcher(
+        const ProgmemCommand* progmemCommands,
+        uint8_t numCommands,
+        const char** argv,
+        uint8_t argvSize,
+        char* tokens = nullptr,
+        line_size_t tokensSize = 0
+    ) :
+        mCommands(nullptr),
+        mProgmemCommands(progmemCommands),
+        mNumCommands(numCommands),
+        mArgv(argv),
+        mArgvSize(argvSize),
+        mSortedIndex(nullptr),
+        mTokens(tokens),
+        mTokensSize(tokensSize)
     {}
 
     /**
      * Tokenize the given 'line', run the matching command handler, and send
-     * output to the 'printer'.
+     * output to the 'printer'. If a `tokens` buffer was given in the
+     * constructor, the tokens are copied into it using copyTokens(), and the
+     * 'line' is not modified, so that it can be logged, echoed or dispatched
+     * again. Otherwise, the tokens are NUL-terminated in place.
+     *
+     * A command handler can call runCommand() again on the same dispatcher.
+     * The nested command uses the argv slots and the token bytes which are
+     * not used by the outer command, so the argv of the outer command remains
+     * valid.
+     *
+     * Return the CommandHandler which was run, or nullptr if the line was
+     * empty, or the command was the built-in 'help', or was not found, or
+     * was a ProgmemCommand. If the command is a long-running command, the
+     * caller must call CommandHandler::poll() until it returns true.
      */
-    void runCommand(Print& printer, char* line) const;
+    const CommandHandler* runCommand(Print& printer, char* line) const;
 
     /**
-     * Tokenize the line, separating tokens delimited by whitespace (space,
-     * formfeed, carriage return, newline, tab, and vertical tab) and fill argv
-     * with each token until argvSize is reached. Return the number of tokens
-     * filled in.
+     * Run the command given by the tokens in argv, which were already split
+     * by copyTokens() or terminateTokens(). This is the second half of
+     * runCommand(),
+     * including the built-in commands, the lookup and the 'Unknown command'
+     * error. Return the same value as runCommand(). Does nothing if 'argc' is
+     * 0.
+     */
+    const CommandHandler* runTokens(Print& printer, int argc,
+        const char* const* argv) const;
+
+    /** Return true if 'cmd' is a built-in command, e.g. 'help'. */
+    static bool isBuiltinCommand(const char* cmd) {
+      if (strcmp(cmd, "help") == 0) return true;
+    #if ACE_UTILS_CLI_ENABLE_STATS
+      if (strcmp(cmd, "stats") == 0) return true;
+    #endif
+      return false;
+    }
+
+    /**
+     * Scan the line in a single pass, without modifying it, and fill `spans`
+     * with the (offset, length) of each token delimited by whitespace (space,
+     * formfeed, carriage return, newline, tab, and vertical tab), until
+     * spansSize is reached. Return the number of spans filled in. Unlike
+     * strtok(), this is reentrant.
+     */
+    static uint8_t tokenizeSpans(
+        const char* line, TokenSpan* spans, uint8_t spansSize);
+
+    /**
+     * Adapter which converts the tokens of the line into the argv array
+     * expected by CommandHandler::run(), without modifying the line. Each
+     * token found by the same scan as tokenizeSpans() is copied into
+     * `tokens`, followed by a NUL, which needs at most `strlen(line) + 1`
+     * bytes. Tokens which are beyond argvSize, or which do not fit into
+     * `tokens`, are dropped. Return the number of tokens filled in.
+     */
+    static uint8_t copyTokens(const char* line, const char** argv,
+        uint8_t argvSize, char* tokens, line_size_t tokensSize);
+
+    /**
+     * Same as copyTokens(), except that each token is NUL-terminated in place,
+     * for a line buffer which is owned by the caller and not used afterwards
+     * (e.g. BoundCommand and WatchCoroutine). Tokens which are beyond
+     * argvSize are left untouched. Return the number of tokens filled in.
+     */
+    static uint8_t terminateTokens(char* line, const char** argv,
+        uint8_t argvSize);
+
+    /**
+     * Tokenize the line in place, separating tokens delimited by whitespace
+     * and fill argv with each token until argvSize is reached. Return the
+     * number of tokens filled in. The line is modified destructively. Use
+     * copyTokens() for a non-destructive version.
      *
      * VisibleForTesting.
      */
     static uint8_t tokenize(char* line, const char** argv, uint8_t argvSize) {
-      char* token = strtok(line, DELIMS);
-      int argc = 0;
-      while (token != nullptr && argc < argvSize) {
-        argv[argc] = token;
-        argc++;
-        token = strtok(nullptr, DELIMS);
-      }
-      return argc;
+      return terminateTokens(line, argv, argvSize);
     }
 
     /**
-     * Find the CommandHandler of the given command name.
+     * Find the CommandHandler of the given command name. Returns nullptr if
+     * not found, or if this dispatcher uses a ProgmemCommand table.
+     *
+     * This is a binary search with O(log(N)) if the commands are sorted by
+     * name, or a sortedIndex was given in the constructor. Otherwise, it is
+     * a linear O(N) scan. See the constructor for details.
      *
      * VisibleForTesting.
+     */
+    const CommandHandler* findCommand(const char* cmd) const;
+
+    /**
+     * Find the ProgmemCommand entry of the given command name using a linear
+     * scan. Returns nullptr if not found, or if this dispatcher uses an array
+     * of CommandHandler. The returned pointer is in PROGMEM.
      *
-     * NOTE: this is currently a linear O(N) scan which is good enough for
-     * small number of commands. If we sorted the handlers, we could do a
-     * binary search for O(log(N)) and handle larger number of commands.
-     */
-    const CommandHandler* findCommand(const char* cmd) const {
-      for (uint8_t i = 0; i < mNumCommands; i++) {
-        const CommandHandler* command = mCommands[i];
-        if (command->getName().compareTo(ace_common::FCString(cmd)) == 0) {
-          return command;
-        }
-      }
-      return nullptr;
+     * VisibleForTesting.
+     */
+    const ProgmemCommand* findProgmemCommand(const char* cmd) const;
+
+    /**
+     * Return the CommandHandler at index 'id' of the `commands` array given
+     * in the constructor, or nullptr if 'id' is out of range. Used by the
+     * binary protocol of FrameProcessor, which identifies the command by its
+     * index instead of its name.
+     */
+    const CommandHandler* getCommand(uint8_t id) const {
+      return (mCommands != nullptr && id < mNumCommands)
+          ? mCommands[id]
+          : nullptr;
+    }
+
+    /**
+     * Run the given command with the given arguments, passing the
+     * ScratchArena (if any) to CommandHandler::runWithArena(), and reset the
+     * arena afterwards. If ACE_UTILS_CLI_ENABLE_STATS is enabled, the elapsed
+     * micros() and the number of bytes written to the 'printer' are recorded
+     * in the CommandHandler.
+     */
+    void runHandler(Print& printer, const CommandHandler* command,
+        int argc, const char* const* argv) const;
+
+    /**
+     * Call CommandHandler::runTyped() of the given command with the typed
+     * arguments of a binary request, and return its result. If it returns
+     * true, the ScratchArena is reset and the statistics are recorded, like
+     * runHandler(). Otherwise, the caller should call runHandler() with the
+     * arguments converted into text.
+     */
+    bool runTypedHandler(Print& printer, const CommandHandler* command,
+        uint8_t numArgs, const ArgValue* args, const uint8_t* types) const;
+
+    /**
+     * Call CommandHandler::poll() of the given long-running command, and
+     * return its result. If ACE_UTILS_CLI_ENABLE_STATS is enabled, the elapsed
+     * micros() and the bytes written are added to the statistics of the
+     * command, like runHandler().
+     */
+    bool pollHandler(Print& printer, const CommandHandler* command) const;
+
+    /**
+     * Pass the next chunk of the payload to CommandHandler::receivePayload()
+     * of the given command. If ACE_UTILS_CLI_ENABLE_STATS is enabled, the
+     * elapsed micros() and the bytes written are added to the statistics of
+     * the command, like runHandler().
+     */
+    void payloadHandler(Print& printer, const CommandHandler* command,
+        const char* data, uint8_t len) const;
+
+    /**
+     * Give the 'arena' to the commands run by this dispatcher, see
+     * ArenaCommandHandler. Pass nullptr to remove it. The arena can be shared
+     * by the sessions of a SessionProcessorManager, because it is reset
+     * after every command.
+     */
+    void setScratchArena(ScratchArena* arena) { mScratchArena = arena; }
+
+    /** Return the ScratchArena, or nullptr. */
+    ScratchArena* getScratchArena() const { return mScratchArena; }
+
+    /** Record a command that was not found. Called by the processors. */
+    void recordUnknownCommand() const {
+    #if ACE_UTILS_CLI_ENABLE_STATS
+      mNumUnknownCommands++;
+    #endif
+    }
+
+    /** Record an input buffer overflow. Called by the processors. */
+    void recordOverflow() const {
+    #if ACE_UTILS_CLI_ENABLE_STATS
+      mNumOverflows++;
+    #endif
+    }
+
+  #if ACE_UTILS_CLI_ENABLE_STATS
+    /** Return the number of commands that were not found. */
+    uint16_t getNumUnknownCommands() const { return mNumUnknownCommands; }
+
+    /** Return the number of input buffer overflows. */
+    uint16_t getNumOverflows() const { return mNumOverflows; }
+  #endif
+
+    /**
+     * Return true if findCommand() uses a binary search. This triggers the
+     * lazy initialization of the lookup strategy. VisibleForTesting.
+     */
+    bool isBinarySearch() const {
+      initLookup();
+      return mLookupMode != kLookupLinear;
     }
 
   private:
@@ -124,6 +340,11 @@ class CommandDispatcher {
     void helpCommandHandler(Print& printer, int argc, const char* const* argv)
         const;
 
+  #if ACE_UTILS_CLI_ENABLE_STATS
+    /** Handle the 'stats' command. */
+    void statsCommandHandler(Print& printer) const;
+  #endif
+
     /** Print help on all commands */
     void helpAll(Print& printer) const;
 
@@ -133,17 +354,84 @@ class CommandDispatcher {
     /** Print help string for the given command. */
     static void printHelp(Print& printer, const CommandHandler* command);
 
-    /** Find and run the given command. */
-    void findAndRunCommand(Print& printer, const char* cmd,
+    /** Print help string for the given ProgmemCommand. */
+    static void printHelp(Print& printer, const ProgmemCommand* entry);
+
+    /** Find and run the given command. Return the command, or nullptr. */
+    const CommandHandler* findAndRunCommand(Print& printer, const char* cmd,
         int argc, const char* const* argv) const;
 
+    /** Determine the lookup strategy if not already done. */
+    void initLookup() const {
+      if (mLookupMode == kLookupUnknown) selectLookup();
+    }
+
+    /** Select the lookup strategy, sorting the mSortedIndex if necessary. */
+    void selectLookup() const;
+
+    /** Return the i'th command in sorted order. */
+    const CommandHandler* sortedCommandAt(uint8_t i) const {
+      return (mLookupMode == kLookupIndex)
+          ? mCommands[mSortedIndex[i]]
+          : mCommands[i];
+    }
+
+    /** Return true if the character is a token delimiter. */
+    static bool isDelim(char c) {
+      return c == ' ' || c == '\f' || c == '\r' || c == '\n' || c == '\t'
+          || c == '\v';
+    }
+
+    /**
+     * Skip the delimiters at 'p', and return the start of the next token, or
+     * nullptr if there are no more tokens. The end of the token is returned
+     * in 'end'. This is the single scanner behind tokenizeSpans(),
+     * copyTokens() and terminateTokens().
+     */
+    static const char* nextToken(const char* p, const char** end) {
+      while (isDelim(*p)) p++;
+      if (*p == '\0') return nullptr;
+      const char* start = p;
+      while (*p != '\0' && ! isDelim(*p)) p++;
+      *end = p;
+      return start;
+    }
+
+    /** Compare the names of the given commands. */
+    static int compareNames(
+        const CommandHandler* a, const CommandHandler* b) {
+      return a->getName().compareTo(b->getName());
+    }
+
   private:
-    static const char DELIMS[];
+    static uint8_t const kLookupUnknown = 0;
+    static uint8_t const kLookupLinear = 1;
+    static uint8_t const kLookupSorted = 2;
+    static uint8_t const kLookupIndex = 3;
 
     const CommandHandler* const* const mCommands;
+    const ProgmemCommand* const mProgmemCommands = nullptr;
     uint8_t const mNumCommands;
     const char** const mArgv;
     uint8_t const mArgvSize;
+    uint8_t* const mSortedIndex;
+    char* const mTokens;
+    line_size_t const mTokensSize;
+    ScratchArena* mScratchArena = nullptr;
+    mutable uint8_t mLookupMode = kLookupUnknown;
+
+    // The argv slots and the token bytes used by the commands which are
+    // running, so that a nested runCommand() uses the ones which follow.
+    mutable uint8_t mArgvUsed = 0;
+    mutable line_size_t mTokensUsed = 0;
+
+    // The number of command handlers which are running, so that the
+    // ScratchArena is reset only by the outermost one.
+    mutable uint8_t mDepth = 0;
+  #if ACE_UTILS_CLI_ENABLE_STATS
+    mutable uint16_t mNumUnknownCommands = 0;
+    mutable uint16_t mNumOverflows = 0;
+  #endif
 };
 
 } // cli
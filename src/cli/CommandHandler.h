@@ -26,12 +26,16 @@ SOFTWARE.
 #define ACE_UTILS_CLI_COMMAND_HANDLER_H
 
 #include <AceCommon.h> // FCString
+#include "CommandStats.h"
 
 class Print;
 
 namespace ace_utils {
 namespace cli {
 
+class ScratchArena;
+union ArgValue;
+
 /**
  * Signature for a command handler.
  */
@@ -55,12 +59,130 @@ class CommandHandler {
     virtual void run(Print& printer, int argc, const char* const* argv)
         const = 0;
 
+   /**
+    * Run the command with a ScratchArena for its temporary buffers. This is
+    * what the CommandDispatcher calls. The default implementation ignores the
+    * arena and calls run(). A command which needs the arena derives from
+    * ArenaCommandHandler instead.
+    *
+    * @param arena The scratch arena of the session, reset after this returns.
+    *        Has a size of 0 if no arena was given to the CommandDispatcher.
+    */
+    virtual void runWithArena(Print& printer, int argc,
+        const char* const* argv, ScratchArena& arena) const {
+      (void) arena;
+      run(printer, argc, argv);
+    }
+
+   /**
+    * Run the command with the typed arguments of a binary request (see
+    * FrameProcessor), whose integers are passed as binary values instead of
+    * text. Return false, without doing anything, if the command accepts only
+    * the text arguments of run(). The FrameProcessor then formats the
+    * integers as text and calls run() instead. The default implementation
+    * returns false. SchemaCommandHandler overrides this.
+    *
+    * @param printer The output printer.
+    * @param numArgs Number of arguments, not including the command name.
+    * @param args The value of each argument.
+    * @param types The type of each argument, either ArgSpec::kTypeInt for an
+    *        integer in ArgValue::i, or ArgSpec::kTypeString for a string in
+    *        ArgValue::s.
+    */
+    virtual bool runTyped(Print& printer, uint8_t numArgs,
+        const ArgValue* args, const uint8_t* types) const {
+      (void) printer;
+      (void) numArgs;
+      (void) args;
+      (void) types;
+      return false;
+    }
+
+   /**
+    * Continue a long-running command which was started by run(), and return
+    * true when the command has finished. The processors call this repeatedly
+    * after run() returns, yielding to the other coroutines between calls, and
+    * hold the input of the session until it returns true. The default
+    * implementation returns true, for a command which finishes inside run().
+    *
+    * A long-running command keeps its progress in mutable member variables,
+    * initialized by run(). The argv array is valid only inside run(), so the
+    * arguments which are needed later must be copied or parsed in run().
+    *
+    * @param printer The same output printer that was passed into run().
+    */
+    virtual bool poll(Print& printer) const {
+      (void) printer;
+      return true;
+    }
+
+   /**
+    * Return the number of payload bytes which follow the command line, to be
+    * passed into receivePayload(). Called once, just after run() returns. The
+    * default implementation returns 0, for a command without a payload.
+    *
+    * A command such as `load 4096` parses the size in run(), and returns it
+    * here. The DirectProcessor and the StreamProcessorCoroutine then pass the
+    * bytes which follow the terminator of the command line to
+    * receivePayload() in chunks, as they arrive, without looking for
+    * terminators. After the last chunk, poll() is called as for a
+    * long-running command. The other processors ignore the payload.
+    */
+    virtual uint32_t getPayloadSize() const { return 0; }
+
+   /**
+    * Receive the next chunk of the payload. See getPayloadSize(). The chunk
+    * is valid only during this call.
+    *
+    * @param printer The same output printer that was passed into run().
+    * @param data The bytes of the chunk.
+    * @param len The number of bytes in the chunk, at most 255.
+    */
+    virtual void receivePayload(Print& printer, const char* data, uint8_t len)
+        const {
+      (void) printer;
+      (void) data;
+      (void) len;
+    }
+
+    /**
+     * Print the name of the command, followed by a space and the help string
+     * if it is not null, without a newline. Used by the `help` command. A
+     * subclass may override this to generate the help string, see
+     * SchemaCommandHandler.
+     */
+    virtual void printUsage(Print& printer) const;
+
     /** Return the name of the command. */
     ace_common::FCString getName() const { return mName; }
 
     /** Return the help string of the command. */
     ace_common::FCString getHelpString() const { return mHelpString; }
 
+  #if ACE_UTILS_CLI_ENABLE_STATS
+    /** Return the execution statistics of this command. */
+    const CommandStats& getStats() const { return mStats; }
+
+    /**
+     * Record one run of this command which took 'elapsedMicros' and wrote
+     * 'bytes' to the printer. Called by the CommandDispatcher.
+     */
+    void recordRun(uint32_t elapsedMicros, uint32_t bytes) const {
+      mStats.count++;
+      recordWork(elapsedMicros, bytes);
+    }
+
+    /**
+     * Record a call to poll() or receivePayload() of this command, which is
+     * part of the same run. Called by the CommandDispatcher.
+     */
+    void recordWork(uint32_t elapsedMicros, uint32_t bytes) const {
+      mStats.totalMicros += elapsedMicros;
+      if (elapsedMicros > mStats.maxMicros) mStats.maxMicros = elapsedMicros;
+      mStats.bytesWritten += bytes;
+    }
+  #endif
+
   protected:
     /**
     * Increment argv and decrement argc so that it appears as if the command
@@ -103,6 +225,9 @@ class CommandHandler {
   private:
     ace_common::FCString const mName;
     ace_common::FCString const mHelpString;
+  #if ACE_UTILS_CLI_ENABLE_STATS
+    mutable CommandStats mStats = {0, 0, 0, 0};
+  #endif
 };
 
 } // cli
@@ -0,0 +1,104 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_COMMAND_STATS_H
+#define ACE_UTILS_CLI_COMMAND_STATS_H
+
+#include <stdint.h>
+
+/**
+ * Set to 1 to record the execution statistics of each CommandHandler, and to
+ * enable the built-in `stats` command. This changes the size of
+ * CommandHandler, so it must be defined for all translation units (e.g. with
+ * a `-D` compiler flag), not just in the sketch.
+ */
+#ifndef ACE_UTILS_CLI_ENABLE_STATS
+  #define ACE_UTILS_CLI_ENABLE_STATS 0
+#endif
+
+#if ACE_UTILS_CLI_ENABLE_STATS
+
+#include <Arduino.h> // Print
+
+namespace ace_utils {
+namespace cli {
+
+/** Execution statistics of a CommandHandler. */
+struct CommandStats {
+  /** Number of times the command was run. */
+  uint16_t count;
+
+  /**
+   * Total micros() spent in CommandHandler::run(), and in the poll() and
+   * receivePayload() calls of the long-running and payload commands.
+   */
+  uint32_t totalMicros;
+
+  /**
+   * Maximum micros() spent in a single call to run(), poll() or
+   * receivePayload(), i.e. the longest time the command held the loop().
+   */
+  uint32_t maxMicros;
+
+  /** Total number of bytes written to the printer. */
+  uint32_t bytesWritten;
+};
+
+/** A Print adapter which counts the bytes written to the underlying Print. */
+class CountingPrint: public Print {
+  public:
+    explicit CountingPrint(Print& printer): mPrinter(printer) {}
+
+    size_t write(uint8_t c) override {
+      size_t n = mPrinter.write(c);
+      mCount += n;
+      return n;
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) override {
+      size_t n = mPrinter.write(buffer, size);
+      mCount += n;
+      return n;
+    }
+
+    using Print::write;
+
+    int availableForWrite() override { return mPrinter.availableForWrite(); }
+
+    void flush() override { mPrinter.flush(); }
+
+    /** Return the number of bytes written. */
+    uint32_t getCount() const { return mCount; }
+
+  private:
+    Print& mPrinter;
+    uint32_t mCount = 0;
+};
+
+} // cli
+} // ace_utils
+
+#endif
+
+#endif
@@ -26,7 +26,11 @@ SOFTWARE.
 #define ACE_UTILS_CLI_DIRECT_PROCESSOR_H
 
 #include <Arduino.h> // Stream, Print
-#include <AceRoutine.h>
+#include "CommandDispatcher.h"
+#include "FlowControl.h"
+#include "LineReader.h"
+#include "LoopJitter.h"
+#include "ProcessBudget.h"
 
 namespace ace_utils {
 namespace cli {
@@ -37,12 +41,27 @@ namespace cli {
  * be the global Serial object. If the input line is too long to overflow the
  * line buffer, the rest of the line is flushed until the next '\\n' or '\\r',
  * and an error message is printed on the given Print output.
+ *
+ * The Stream is read in blocks using a LineReader, so all the bytes which are
+ * available are read with a single Stream::readBytes() call, and multiple
+ * commands can be handled in a single call to process().
+ *
+ * If a command is long-running (see CommandHandler::poll()), process()
+ * returns after each poll() until the command finishes, and the remaining
+ * input is held until then. If a command has a payload (see
+ * CommandHandler::getPayloadSize()), the bytes which follow the command line
+ * are passed to the command in chunks before it is polled.
+ *
+ * By default, process() handles all the input which is available. The work
+ * done by a single call can be limited using setBudget(), in which case
+ * process() returns early and continues from the same place on the next call.
+ *
+ * An optional FlowControl, set using setFlowControl(), tells the host to stop
+ * sending while the input is backing up in the Stream, and before a command
+ * is run while more input is waiting. It tells the host to resume when the
+ * command has finished and the input has been processed.
  */
 class DirectProcessor {
-  private:
-    static uint8_t const kBufferOk = 0;
-    static uint8_t const kBufferOverflow = 1;
-
   public:
     /**
      * Constructor.
@@ -61,55 +80,105 @@ class DirectProcessor {
         const CommandDispatcher& commandDispatcher,
         Print& printer,
         char* buffer,
-        uint8_t bufferSize,
+        line_size_t bufferSize,
         const char* prompt = nullptr
     ):
         mCommandDispatcher(commandDispatcher),
         mStream(stream),
         mPrinter(printer),
-        mBuf(buffer),
-        mBufSize(bufferSize),
+        mLineReader(buffer, bufferSize),
         mPrompt(prompt)
     {}
 
     /**
-     * Main body of the coroutine that reads a character from the input stream
-     * and writes it into the output channel.
+     * Read all the bytes which are available from the input stream, and
+     * execute each complete line using the CommandDispatcher.
      */
     void process() {
+      mBudget.start();
+      if (mActiveCommand != nullptr) {
+        markBusy();
+        if (! continueActiveCommand()) return;
+        mActiveCommand = nullptr;
+      }
+
       if (mPrompt && mShouldPrompt) {
         mPrinter.print(mPrompt);
         mPrinter.flush();
         mShouldPrompt = false;
       }
-      if (mStream.available() == 0) return;
 
-      // There could be multiple bytes waiting, so loop to get all of them.
-      while (mStream.available() > 0) {
-        char c = mStream.read();
-        mBuf[mIndex] = c;
-        mIndex++;
+      // There could be multiple lines waiting, so loop to get all of them.
+      while (true) {
+        if (mBudget.isExhausted()) {
+          if (! hasInput()) break;
+          // The lines left in the line buffer are not visible in the
+          // available() of the Stream, so keep the host stopped.
+          mBudget.recordHit();
+          updateFlowControl(true);
+          return;
+        }
 
-        if (mIndex >= mBufSize - 1) {
-          resetBuffer();
+        uint8_t status = mLineReader.next();
+        if (status == LineReader::kStatusNone) {
+          uint8_t n = mLineReader.fill(mStream, mBudget.getByteAllowance());
+          if (n == 0) break;
+          mBudget.addBytes(n);
+        } else if (status == LineReader::kStatusLine) {
+          mShouldPrompt = true;
+          mBudget.addCommand();
+          markBusy();
+          pauseIfInputPending();
+          mActiveCommand =
+              mCommandDispatcher.runCommand(mPrinter, mLineReader.getLine());
+          if (mActiveCommand != nullptr) {
+            mPayloadRemaining = mActiveCommand->getPayloadSize();
+            if (! continueActiveCommand()) return;
+            mActiveCommand = nullptr;
+          }
+        } else if (status == LineReader::kStatusOverflow) {
+          mCommandDispatcher.recordOverflow();
           mPrinter.println(
               F("Error: Buffer overflow... flushing until Newline"));
-          mBufStatus = kBufferOverflow;
-        } else if (c == '\n' || c == '\r') {
-          resetBuffer();
+        } else {
+          // If the buffer had previously overflown, then flush all input
+          // until the \n or \r.
           mShouldPrompt = true;
-
-          if (mBufStatus == kBufferOk) {
-            mCommandDispatcher.runCommand(mPrinter, mBuf);
-          } else {
-            // If the buffer had previously overflown, then flush all input
-            // until the \n or \r.
-            mPrinter.println(
-                F("Error: Buffer overflow... flushed after Newline"));
-            mBufStatus = kBufferOk;
-          }
+          mPrinter.println(
+              F("Error: Buffer overflow... flushed after Newline"));
         }
       }
+      updateFlowControl(false);
+    }
+
+    /**
+     * Limit the work done by a single call to process(). See ProcessBudget.
+     * A limit of 0 means unlimited.
+     */
+    void setBudget(uint16_t maxBytes, uint8_t maxCommands, uint32_t maxMicros) {
+      mBudget.setLimits(maxBytes, maxCommands, maxMicros);
+    }
+
+    /** Return the number of calls to process() which stopped early. */
+    uint16_t getNumBudgetHits() const { return mBudget.getNumHits(); }
+
+    /**
+     * Call LoopJitter::markBusy() with the given tag whenever a command is
+     * run, so that the outliers of the loop gap can be attributed to this
+     * processor. Pass nullptr to disable.
+     */
+    void setLoopJitter(LoopJitter* loopJitter, const char* tag) {
+      mLoopJitter = loopJitter;
+      mJitterTag = tag;
+    }
+
+    /**
+     * Tell the host to stop and resume sending using the given FlowControl,
+     * instead of relying on the host to throttle its input. Pass nullptr to
+     * disable.
+     */
+    void setFlowControl(FlowControl* flowControl) {
+      mFlowControl = flowControl;
     }
 
   private:
@@ -117,26 +186,88 @@ class DirectProcessor {
     DirectProcessor(const DirectProcessor&) = delete;
     DirectProcessor& operator=(const DirectProcessor&) = delete;
 
+    void markBusy() {
+      if (mLoopJitter) mLoopJitter->markBusy(mJitterTag);
+    }
+
     /**
-     * Terminate the current buffer with the NUL character (so that the current
-     * string can be retrieved), and reset the character index to the beginning
-     * of the buffer to prepare for the next mStream.read();
+     * Pass the payload to the active command, then poll it. Return true when
+     * the command has finished.
      */
-    void resetBuffer() {
-      mBuf[mIndex] = '\0';
-      mIndex = 0;
+    bool continueActiveCommand() {
+      if (mPayloadRemaining > 0) {
+        receivePayload();
+        updateFlowControl(false);
+        if (mPayloadRemaining > 0) return false;
+      }
+      bool done = mCommandDispatcher.pollHandler(mPrinter, mActiveCommand);
+      // When the command is done, the host is told to resume only after the
+      // input which is waiting in the line buffer has been processed.
+      if (! done) updateFlowControl(true);
+      return done;
+    }
+
+    /**
+     * Pass the payload bytes which are available to the active command, in
+     * chunks of at most 255 bytes, using the line buffer. Stops after a chunk
+     * if the budget is used up.
+     */
+    void receivePayload() {
+      while (mPayloadRemaining > 0) {
+        char* data;
+        uint8_t maxBytes =
+            (mPayloadRemaining > 255) ? 255 : (uint8_t) mPayloadRemaining;
+        uint8_t n = mLineReader.takePending(data, maxBytes);
+        if (n == 0) {
+          n = mLineReader.fill(mStream, mBudget.getByteAllowance());
+          if (n == 0) return;
+          mBudget.addBytes(n);
+          continue;
+        }
+        mCommandDispatcher.payloadHandler(mPrinter, mActiveCommand, data, n);
+        mPayloadRemaining -= n;
+        if (mPayloadRemaining > 0 && mBudget.isExhausted()) {
+          if (hasInput()) mBudget.recordHit();
+          return;
+        }
+      }
+    }
+
+    /** Update the FlowControl, if any. */
+    void updateFlowControl(bool busy) {
+      if (mFlowControl) mFlowControl->update(mStream.available(), busy);
+    }
+
+    /**
+     * Tell the host to stop if more input is waiting, because the input is
+     * not read while the command runs. The bytes which are already in the
+     * line buffer have drained the receive buffer of the Stream, so its
+     * available() does not show the backlog.
+     */
+    void pauseIfInputPending() {
+      if (mFlowControl && hasInput()) {
+        mFlowControl->update(mStream.available(), true);
+      }
+    }
+
+    /** Return true if there is more input to process. */
+    bool hasInput() {
+      return mLineReader.hasPending() || mStream.available() > 0;
     }
 
   private:
     const CommandDispatcher& mCommandDispatcher;
     Stream& mStream;
     Print& mPrinter;
-    char* const mBuf;
-    uint8_t const mBufSize;
+    LineReader mLineReader;
+    ProcessBudget mBudget;
     const char* const mPrompt;
+    const CommandHandler* mActiveCommand = nullptr;
+    uint32_t mPayloadRemaining = 0;
+    LoopJitter* mLoopJitter = nullptr;
+    const char* mJitterTag = nullptr;
+    FlowControl* mFlowControl = nullptr;
 
-    uint8_t mIndex = 0;
-    uint8_t mBufStatus = kBufferOk;
     bool mShouldPrompt = true;
 };
 
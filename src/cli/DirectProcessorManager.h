@@ -74,10 +74,11 @@ namespace cli {
  * }
  * @endcode
  *
- * @param BUF_SIZE Size of the input line buffer.
+ * @param BUF_SIZE Size of the input line buffer. Can be larger than 255 if
+ *        ACE_UTILS_CLI_WIDE_LINES is set to 1.
  * @param ARGV_SIZE Size of the command line argv token list.
  */
-template<uint8_t BUF_SIZE, uint8_t ARGV_SIZE>
+template<line_size_t BUF_SIZE, uint8_t ARGV_SIZE>
 class DirectProcessorManager {
   public:
 
@@ -99,7 +100,32 @@ class DirectProcessorManager {
         Print& printer,
         const char* prompt = nullptr
     ) :
-        mCommandDispatcher(commands, numCommands, mArgv, ARGV_SIZE),
+        mCommandDispatcher(commands, numCommands, mArgv, ARGV_SIZE,
+            nullptr /*sortedIndex*/, mTokens, BUF_SIZE),
+        mDirectProcessor(
+            stream, mCommandDispatcher, printer, mLineBuffer, BUF_SIZE, prompt)
+    {}
+
+    /**
+     * Constructor using a table of ProgmemCommand in flash memory instead of
+     * an array of CommandHandler pointers, to save RAM.
+     *
+     * @param stream The serial port used to read commands and send output.
+     * @param progmemCommands Array of ProgmemCommand in PROGMEM.
+     * @param numCommands Number of commands in 'progmemCommands'.
+     * @param printer output stream, often the same as `stream` but not always
+     * @param prompt Print this prompt just before accepting character inputs.
+     *        If null, don't print the prompt.
+     */
+    DirectProcessorManager(
+        Stream& stream,
+        const ProgmemCommand* progmemCommands,
+        uint8_t numCommands,
+        Print& printer,
+        const char* prompt = nullptr
+    ) :
+        mCommandDispatcher(progmemCommands, numCommands, mArgv, ARGV_SIZE,
+            mTokens, BUF_SIZE),
         mDirectProcessor(
             stream, mCommandDispatcher, printer, mLineBuffer, BUF_SIZE, prompt)
     {}
@@ -114,6 +140,22 @@ class DirectProcessorManager {
       return mDirectProcessor;
     }
 
+    /**
+     * Return the underlying CommandDispatcher, e.g. to create a BoundCommand
+     * or to give it to a WatchManager.
+     */
+    const CommandDispatcher& getCommandDispatcher() const {
+      return mCommandDispatcher;
+    }
+
+    /**
+     * Give the ScratchArena to the commands, see
+     * CommandDispatcher::setScratchArena().
+     */
+    void setScratchArena(ScratchArena* arena) {
+      mCommandDispatcher.setScratchArena(arena);
+    }
+
   private:
     // Disable copy-constructor and assignment operator
     DirectProcessorManager(const DirectProcessorManager&) = delete;
@@ -124,6 +166,7 @@ class DirectProcessorManager {
     DirectProcessor mDirectProcessor;
     char mLineBuffer[BUF_SIZE];
     const char* mArgv[ARGV_SIZE];
+    char mTokens[BUF_SIZE];
 };
 
 } // cli
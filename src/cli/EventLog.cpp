@@ -0,0 +1,118 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include <Arduino.h> // Print, pgm_read_byte(), noInterrupts()
+#include "NumberFormat.h"
+#include "EventLog.h"
+
+namespace ace_utils {
+namespace cli {
+
+uint16_t EventLog::printTo(Print& printer, uint16_t maxEvents) const {
+  // Snapshot the range of sequence numbers, since an interrupt handler may
+  // log more events while they are printed.
+  noInterrupts();
+  uint32_t end = mNumLogged;
+  uint16_t count = (maxEvents < mCount) ? maxEvents : mCount;
+  interrupts();
+
+  uint16_t numPrinted = 0;
+  for (uint32_t sequence = end - count; sequence != end; sequence++) {
+    Entry entry;
+    if (! copyEntry(sequence, entry)) continue;
+    printer.write('#');
+    NumberFormat::printUint(printer, sequence);
+    printer.write(' ');
+    NumberFormat::printUint(printer, entry.millis);
+    printer.print(F(": "));
+    printMessage(printer, entry);
+    printer.println();
+    numPrinted++;
+  }
+  return numPrinted;
+}
+
+bool EventLog::copyEntry(uint32_t sequence, Entry& entry) const {
+  noInterrupts();
+  uint32_t offset = sequence - (mNumLogged - mCount);
+  bool found = offset < mCount;
+  if (found) entry = getEntry(offset);
+  interrupts();
+  return found;
+}
+
+void EventLog::printMessage(Print& printer, const Entry& entry) {
+  const char* p = (const char*) entry.format;
+  if (p == nullptr) return;
+
+  uint8_t argIndex = 0;
+  char c;
+  while ((c = pgm_read_byte(p++)) != '\0') {
+    if (c != '%') {
+      printer.write(c);
+      continue;
+    }
+
+    char conversion = pgm_read_byte(p);
+    if (conversion == '%') {
+      printer.write('%');
+      p++;
+      continue;
+    }
+    if (conversion != 'd' && conversion != 'u' && conversion != 'x'
+        && conversion != 'c') {
+      // Not a conversion, print the '%' as is.
+      printer.write('%');
+      continue;
+    }
+    p++;
+
+    if (argIndex >= entry.numArgs) {
+      printer.print(F("<?>"));
+      continue;
+    }
+    uint32_t arg = entry.args[argIndex++];
+    switch (conversion) {
+      case 'd':
+        NumberFormat::printInt(printer, (int32_t) arg);
+        break;
+      case 'u':
+        NumberFormat::printUint(printer, arg);
+        break;
+      case 'x': {
+        uint8_t width = 1;
+        while (width < 8 && (arg >> (4 * width)) != 0) width++;
+        NumberFormat::printHex(printer, arg, width);
+        break;
+      }
+      default:
+        printer.write((char) arg);
+        break;
+    }
+  }
+}
+
+} // cli
+} // ace_utils
@@ -0,0 +1,235 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef ACE_UTILS_CLI_EVENT_LOG_H
+#define ACE_UTILS_CLI_EVENT_LOG_H
+
+#include <stdint.h>
+#include <Arduino.h> // millis(), Print, __FlashStringHelper
+
+namespace ace_utils {
+namespace cli {
+
+/**
+ * A ring buffer of binary log events, for debugging the timing-sensitive parts
+ * of a program without the cost of Print::print() on the hot path. Each event
+ * stores only the address of its `F()` format string, the raw argument words,
+ * and the millis() when it was logged. The formatting is deferred until the
+ * events are printed, usually by the `log` command of an EventLogCommand.
+ *
+ * When the ring is full, the oldest event is overwritten, and counted in
+ * getNumDropped(). Each event has a sequence number, so a gap in the printed
+ * sequence numbers shows where the events were dropped.
+ *
+ * The format string supports the following conversions, consuming one
+ * argument each:
+ *
+ *  * `%d` signed decimal
+ *  * `%u` unsigned decimal
+ *  * `%x` hexadecimal
+ *  * `%c` character
+ *  * `%%` a literal '%'
+ *
+ * Other characters are printed as is. Strings cannot be logged because the
+ * pointer may be invalid by the time the event is printed.
+ *
+ * The log() methods are not reentrant. If events are logged from an interrupt
+ * handler, the calls from the main loop must disable interrupts around them.
+ * The printTo() method copies each event with interrupts disabled, so it can
+ * run in the main loop while an interrupt handler logs events. The events
+ * which are overwritten while printTo() runs are skipped, leaving a gap in
+ * the sequence numbers.
+ *
+ * Example usage:
+ *
+ * @code
+ * FixedEventLog<64> eventLog;
+ *
+ * void onPacket(uint16_t id, int16_t rssi) {
+ *   eventLog.log(F("packet id=%u rssi=%d"), id, rssi);
+ * }
+ * @endcode
+ */
+class EventLog {
+  public:
+    /** Maximum number of arguments of an event. */
+    static uint8_t const kMaxArgs = 3;
+
+    /** A logged event. */
+    struct Entry {
+      /** The format string in flash memory. */
+      const __FlashStringHelper* format;
+
+      /** The millis() when the event was logged. */
+      uint32_t millis;
+
+      /** The raw argument words. */
+      uint32_t args[kMaxArgs];
+
+      /** Number of valid elements in 'args'. */
+      uint8_t numArgs;
+    };
+
+    /**
+     * Constructor.
+     *
+     * @param entries storage of the ring
+     * @param numEntries size of the 'entries' array, must be at least 1
+     */
+    EventLog(Entry* entries, uint16_t numEntries):
+        mEntries(entries),
+        mNumEntries(numEntries)
+    {}
+
+    /** Log an event with no arguments. */
+    void log(const __FlashStringHelper* format) {
+      push(format, 0);
+    }
+
+    /** Log an event with 1 argument. */
+    void log(const __FlashStringHelper* format, uint32_t a0) {
+      Entry& entry = push(format, 1);
+      entry.args[0] = a0;
+    }
+
+    /** Log an event with 2 arguments. */
+    void log(const __FlashStringHelper* format, uint32_t a0, uint32_t a1) {
+      Entry& entry = push(format, 2);
+      entry.args[0] = a0;
+      entry.args[1] = a1;
+    }
+
+    /** Log an event with 3 arguments. */
+    void log(const __FlashStringHelper* format, uint32_t a0, uint32_t a1,
+        uint32_t a2) {
+      Entry& entry = push(format, 3);
+      entry.args[0] = a0;
+      entry.args[1] = a1;
+      entry.args[2] = a2;
+    }
+
+    /** Remove all the events, and reset the counters. */
+    void clear() {
+      mHead = 0;
+      mCount = 0;
+      mNumLogged = 0;
+      mNumDropped = 0;
+    }
+
+    /** Return the capacity of the ring. */
+    uint16_t getNumEntries() const { return mNumEntries; }
+
+    /** Return the number of events in the ring. */
+    uint16_t getCount() const { return mCount; }
+
+    /** Return the number of events logged since the last clear(). */
+    uint32_t getNumLogged() const { return mNumLogged; }
+
+    /** Return the number of events overwritten since the last clear(). */
+    uint32_t getNumDropped() const { return mNumDropped; }
+
+    /**
+     * Return the i'th event in the ring, where 0 is the oldest. Valid for
+     * i < getCount(). If an interrupt handler logs events, this must be called
+     * with interrupts disabled, and the event copied before enabling them.
+     */
+    const Entry& getEntry(uint16_t i) const {
+      uint16_t index = mHead + mNumEntries - mCount + i;
+      if (index >= mNumEntries) index -= mNumEntries;
+      return mEntries[index];
+    }
+
+    /** Return the sequence number of the i'th event in the ring. */
+    uint32_t getSequence(uint16_t i) const {
+      return mNumLogged - mCount + i;
+    }
+
+    /**
+     * Print the latest 'maxEvents' events, oldest first, one per line,
+     * prefixed with their sequence number and millis. Return the number of
+     * events printed. Each event is copied with interrupts disabled, and
+     * printed after enabling them, so this must not be called with interrupts
+     * disabled.
+     */
+    uint16_t printTo(Print& printer, uint16_t maxEvents = 0xFFFF) const;
+
+    /** Format the message of the given event, without a newline. */
+    static void printMessage(Print& printer, const Entry& entry);
+
+  private:
+    // Disable copy-constructor and assignment operator
+    EventLog(const EventLog&) = delete;
+    EventLog& operator=(const EventLog&) = delete;
+
+    /**
+     * Copy the event with the given sequence number into 'entry', with
+     * interrupts disabled. Return false if the event is no longer in the ring.
+     */
+    bool copyEntry(uint32_t sequence, Entry& entry) const;
+
+    /** Claim the next slot of the ring, overwriting the oldest if full. */
+    Entry& push(const __FlashStringHelper* format, uint8_t numArgs) {
+      Entry& entry = mEntries[mHead];
+      mHead++;
+      if (mHead == mNumEntries) mHead = 0;
+      if (mCount < mNumEntries) {
+        mCount++;
+      } else {
+        mNumDropped++;
+      }
+      mNumLogged++;
+      entry.format = format;
+      entry.millis = millis();
+      entry.numArgs = numArgs;
+      return entry;
+    }
+
+  private:
+    Entry* const mEntries;
+    uint16_t const mNumEntries;
+    uint16_t mHead = 0;
+    uint16_t mCount = 0;
+    uint32_t mNumLogged = 0;
+    uint32_t mNumDropped = 0;
+};
+
+/**
+ * An EventLog which owns a ring of NUM_ENTRIES events.
+ *
+ * @param NUM_ENTRIES capacity of the ring
+ */
+template <uint16_t NUM_ENTRIES>
+class FixedEventLog: public EventLog {
+  public:
+    FixedEventLog(): EventLog(mBuffer, NUM_ENTRIES) {}
+
+  private:
+    Entry mBuffer[NUM_ENTRIES];
+};
+
+} // cli
+} // ace_utils
+
+#endif
@@ -0,0 +1,75 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include <stdlib.h> // strtol()
+#include <Arduino.h> // Print, F()
+#include "EventLogCommand.h"
+
+namespace ace_utils {
+namespace cli {
+
+EventLogCommand::EventLogCommand(EventLog& eventLog):
+    CommandHandler(F("log"), F("[tail [n] | clear]")),
+    mEventLog(eventLog)
+{}
+
+void EventLogCommand::run(Print& printer, int argc, const char* const* argv)
+    const {
+  uint16_t maxEvents = 0xFFFF;
+  bool isValid = true;
+  if (argc == 2 && isArgEqual(argv[1], F("clear"))) {
+    mEventLog.clear();
+    return;
+  } else if ((argc == 2 || argc == 3) && isArgEqual(argv[1], F("tail"))) {
+    maxEvents = kDefaultTail;
+    if (argc == 3) {
+      char* end;
+      long n = strtol(argv[2], &end, 10);
+      if (n <= 0 || n > 65535 || *end != '\0') {
+        isValid = false;
+      } else {
+        maxEvents = n;
+      }
+    }
+  } else if (argc != 1) {
+    isValid = false;
+  }
+
+  if (! isValid) {
+    printer.print(F("Usage: "));
+    printUsage(printer);
+    printer.println();
+    return;
+  }
+
+  printer.print(F("Events: logged="));
+  printer.print(mEventLog.getNumLogged());
+  printer.print(F("; dropped="));
+  printer.println(mEventLog.getNumDropped());
+  mEventLog.printTo(printer, maxEvents);
+}
+
+} // cli
+} // ace_utils
@@ -0,0 +1,68 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef ACE_UTILS_CLI_EVENT_LOG_COMMAND_H
+#define ACE_UTILS_CLI_EVENT_LOG_COMMAND_H
+
+#include "CommandHandler.h"
+#include "EventLog.h"
+
+namespace ace_utils {
+namespace cli {
+
+/**
+ * A CommandHandler which formats and prints the events of an EventLog.
+ *
+ *  * `log` prints all the events in the ring
+ *  * `log tail [n]` prints the latest n events (default 10)
+ *  * `log clear` removes the events and resets the counters
+ *
+ * The events are preceded by a line with the number of events logged and
+ * dropped since the last `log clear`.
+ */
+class EventLogCommand: public CommandHandler {
+  public:
+    /** Default number of events printed by `log tail`. */
+    static uint16_t const kDefaultTail = 10;
+
+    /** Constructor. */
+    explicit EventLogCommand(EventLog& eventLog);
+
+    void run(Print& printer, int argc, const char* const* argv)
+        const override;
+
+  private:
+    // Disable copy-constructor and assignment operator
+    EventLogCommand(const EventLogCommand&) = delete;
+    EventLogCommand& operator=(const EventLogCommand&) = delete;
+
+  private:
+    EventLog& mEventLog;
+};
+
+} // cli
+} // ace_utils
+
+#endif
@@ -0,0 +1,425 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_FD_SERVER_H
+#define ACE_UTILS_CLI_FD_SERVER_H
+
+// Only on Linux host builds, which have epoll.
+#if defined(EPOXY_DUINO) && defined(__linux__)
+
+#include <errno.h>
+#include <string.h> // strncpy()
+#include <unistd.h> // close(), unlink()
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "CommandDispatcher.h"
+#include "FdStream.h"
+#include "LineBufferPool.h"
+#include "SessionProcessor.h"
+
+namespace ace_utils {
+namespace cli {
+
+/**
+ * A host-only server which accepts up to MAX_CLIENTS clients on a
+ * Unix-domain socket (and any other file descriptor given to addClient(),
+ * e.g. a pty master), and serves each client through its own FdStream and
+ * SessionProcessor, using a shared CommandDispatcher and a pool of
+ * NUM_BUFFERS line buffers, like the SessionProcessorManager. The descriptors
+ * are watched using epoll, so only the clients which have input (or which
+ * run a long-running command) are processed. A partial line waits in its
+ * line buffer until the next bytes arrive on the descriptor. This is used
+ * to run the firmware as a simulator on Linux using EpoxyDuino, and to
+ * load-test the CLI with many concurrent scripted clients. Available only if
+ * EPOXY_DUINO and __linux__ are defined.
+ *
+ * A client is disconnected when it closes its end of the socket, after its
+ * remaining input has been processed. No prompt is printed.
+ *
+ * The output which a client does not read fast enough is kept in its FdStream
+ * (see FdStream::flushOutput()). While that output is waiting, the descriptor
+ * is watched for EPOLLOUT instead of EPOLLIN, so the input of the client is
+ * not read, and its commands are not run, until the output has drained. The
+ * output which overflows the FdStream is dropped, and counted in
+ * getNumDroppedBytes().
+ *
+ * A client whose bytes arrive while all the line buffers are in use is
+ * removed from the epoll set, so that its unread input does not wake up
+ * epoll_wait() again and again. It is watched again, in turn, when a line
+ * buffer is released.
+ *
+ * Example usage:
+ *
+ * @code
+ * FdServer<BUF_SIZE, ARGV_SIZE, 8, 256> server(COMMANDS, NUM_COMMANDS);
+ *
+ * void setup() {
+ *   server.listen("/tmp/firmware.sock");
+ * }
+ *
+ * void loop() {
+ *   server.process(10);
+ * }
+ * @endcode
+ *
+ * @param BUF_SIZE Size of each input line buffer.
+ * @param ARGV_SIZE Size of the command line argv token list.
+ * @param NUM_BUFFERS Number of line buffers in the pool.
+ * @param MAX_CLIENTS Maximum number of concurrent clients.
+ */
+template<uint8_t BUF_SIZE, uint8_t ARGV_SIZE, uint8_t NUM_BUFFERS,
+    uint16_t MAX_CLIENTS>
+class FdServer {
+  public:
+    /**
+     * Constructor.
+     *
+     * @param commands Array of (CommandHandler*).
+     * @param numCommands Number of commands in 'commands'.
+     */
+    FdServer(
+        const CommandHandler* const* commands,
+        uint8_t numCommands
+    ) :
+        mBufferPool(&mBuffers[0][0], BUF_SIZE, NUM_BUFFERS, mFreeList),
+        mCommandDispatcher(commands, numCommands, mArgv, ARGV_SIZE,
+            nullptr /*sortedIndex*/, mTokens, BUF_SIZE)
+    {}
+
+    /** Destructor. Disconnect the clients and close the listening socket. */
+    ~FdServer() { close(); }
+
+    /**
+     * Listen for clients on the Unix-domain socket at 'path'. An existing
+     * socket file at 'path' is removed first. Return false on error, with
+     * the reason in errno.
+     */
+    bool listen(const char* path) {
+      if (! openEpoll()) return false;
+
+      struct sockaddr_un addr;
+      memset(&addr, 0, sizeof(addr));
+      addr.sun_family = AF_UNIX;
+      strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+      unlink(addr.sun_path);
+
+      mListenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+      if (mListenFd < 0) return false;
+      if (bind(mListenFd, (struct sockaddr*) &addr, sizeof(addr)) < 0
+          || ::listen(mListenFd, kBacklog) < 0
+          || ! watch(mListenFd, kListenIndex)) {
+        ::close(mListenFd);
+        mListenFd = -1;
+        return false;
+      }
+      return true;
+    }
+
+    /**
+     * Serve the client on the file descriptor 'fd', which is closed when the
+     * client disconnects. Return false if MAX_CLIENTS are already connected,
+     * in which case 'fd' is left open.
+     */
+    bool addClient(int fd) {
+      if (! openEpoll()) return false;
+      if (mNumClients >= MAX_CLIENTS) return false;
+
+      uint16_t index = 0;
+      while (mClients[index].stream.getInFd() >= 0) index++;
+      Client& client = mClients[index];
+      client.stream.attach(fd, fd);
+      if (! watch(fd, index)) {
+        client.stream.detach();
+        return false;
+      }
+      mNumClients++;
+      return true;
+    }
+
+    /**
+     * Wait up to 'timeoutMillis' for input, then accept the new clients, run
+     * the commands of the clients, and disconnect the clients which have
+     * closed their end. Does not wait if a client already needs attention.
+     */
+    void process(int timeoutMillis = 0) {
+      if (mEpollFd < 0) return;
+
+      struct epoll_event events[kMaxEvents];
+      int n = epoll_wait(mEpollFd, events, kMaxEvents,
+          (mNumPending > 0) ? 0 : timeoutMillis);
+      for (int i = 0; i < n; i++) {
+        uint32_t index = events[i].data.u32;
+        if (index == kListenIndex) {
+          acceptClients();
+        } else if (mClients[index].writing) {
+          flushClient(index);
+        } else {
+          markPending(index);
+        }
+      }
+
+      if (mNumPending > 0) {
+        for (uint16_t i = 0; i < MAX_CLIENTS; i++) {
+          if (mClients[i].pending) processClient(i);
+        }
+      }
+      if (mNumStarved > 0) retryStarved();
+    }
+
+    /** Disconnect all the clients, and close the listening socket. */
+    void close() {
+      for (uint16_t i = 0; i < MAX_CLIENTS; i++) {
+        if (mClients[i].stream.getInFd() >= 0) removeClient(i);
+      }
+      if (mListenFd >= 0) {
+        ::close(mListenFd);
+        mListenFd = -1;
+      }
+      if (mEpollFd >= 0) {
+        ::close(mEpollFd);
+        mEpollFd = -1;
+      }
+    }
+
+    /** Return the number of connected clients. */
+    uint16_t getNumClients() const { return mNumClients; }
+
+    /** Return the number of clients accepted since the start. */
+    uint32_t getNumAccepted() const { return mNumAccepted; }
+
+    /** Return the number of clients rejected because of MAX_CLIENTS. */
+    uint32_t getNumRejected() const { return mNumRejected; }
+
+    /**
+     * Return the number of output bytes dropped because a client did not read
+     * its output fast enough, or had gone away, including the clients which
+     * have since disconnected.
+     */
+    uint32_t getNumDroppedBytes() const {
+      uint32_t numDropped = mNumDroppedBytes;
+      for (uint16_t i = 0; i < MAX_CLIENTS; i++) {
+        const FdStream& stream = mClients[i].stream;
+        if (stream.getInFd() >= 0) numDropped += stream.getNumDropped();
+      }
+      return numDropped;
+    }
+
+    /**
+     * Return the number of clients which wait for a free line buffer before
+     * their input is read.
+     */
+    uint16_t getNumStarved() const { return mNumStarved; }
+
+    /** Return the pool of line buffers. */
+    LineBufferPool& getBufferPool() { return mBufferPool; }
+
+    /** Return the shared CommandDispatcher. */
+    const CommandDispatcher& getCommandDispatcher() const {
+      return mCommandDispatcher;
+    }
+
+    /**
+     * Give the ScratchArena to the commands, see
+     * CommandDispatcher::setScratchArena().
+     */
+    void setScratchArena(ScratchArena* arena) {
+      mCommandDispatcher.setScratchArena(arena);
+    }
+
+  private:
+    /** The epoll index of the listening socket. */
+    static uint32_t const kListenIndex = 0xFFFFFFFF;
+
+    /** Maximum number of events handled by a single epoll_wait(). */
+    static int const kMaxEvents = 64;
+
+    /** Backlog of the listening socket. */
+    static int const kBacklog = 128;
+
+    /** The state of a client. Free if the stream is detached. */
+    struct Client {
+      Client(): session(stream, stream) {}
+
+      FdStream stream;
+      SessionProcessor session;
+      bool pending = false; // needs processClient()
+      bool writing = false; // watched for EPOLLOUT, until the output drains
+      bool starved = false; // not watched, until a line buffer is free
+    };
+
+    // Disable copy-constructor and assignment operator
+    FdServer(const FdServer&) = delete;
+    FdServer& operator=(const FdServer&) = delete;
+
+    bool openEpoll() {
+      if (mEpollFd < 0) mEpollFd = epoll_create1(0);
+      return mEpollFd >= 0;
+    }
+
+    bool watch(int fd, uint32_t index, int op = EPOLL_CTL_ADD,
+        uint32_t events = EPOLLIN) {
+      struct epoll_event event;
+      memset(&event, 0, sizeof(event));
+      event.events = events;
+      event.data.u32 = index;
+      return epoll_ctl(mEpollFd, op, fd, &event) == 0;
+    }
+
+    void acceptClients() {
+      while (true) {
+        int fd = accept4(mListenFd, nullptr, nullptr, SOCK_NONBLOCK);
+        if (fd < 0) {
+          if (errno == EINTR) continue;
+          return;
+        }
+        if (addClient(fd)) {
+          mNumAccepted++;
+        } else {
+          mNumRejected++;
+          ::close(fd);
+        }
+      }
+    }
+
+    void markPending(uint16_t index) {
+      if (mClients[index].pending) return;
+      mClients[index].pending = true;
+      mNumPending++;
+    }
+
+    void clearPending(uint16_t index) {
+      if (! mClients[index].pending) return;
+      mClients[index].pending = false;
+      mNumPending--;
+    }
+
+    /**
+     * Run the commands of the client. The client remains pending while it
+     * runs a long-running command, or while its input is held in the FdStream
+     * behind a long-running command. A partial line in the line buffer does
+     * not keep the client pending, since nothing can complete it until epoll
+     * reports more input. A client whose output is backed up waits for
+     * EPOLLOUT, and a client which found no free line buffer waits for
+     * retryStarved().
+     */
+    void processClient(uint16_t index) {
+      Client& client = mClients[index];
+      client.session.process(mCommandDispatcher, mBufferPool);
+      if (client.stream.hasPendingOutput()) {
+        client.writing = true;
+        watch(client.stream.getInFd(), index, EPOLL_CTL_MOD, EPOLLOUT);
+        clearPending(index);
+      } else if (! client.session.isActive() && client.stream.hasBuffered()) {
+        client.starved = true;
+        mNumStarved++;
+        epoll_ctl(mEpollFd, EPOLL_CTL_DEL, client.stream.getInFd(), nullptr);
+        clearPending(index);
+      } else if (client.stream.hasBuffered()) {
+        return;
+      } else if (client.stream.isEof()) {
+        removeClient(index);
+      } else if (! client.session.hasActiveCommand()) {
+        clearPending(index);
+      }
+    }
+
+    /**
+     * Send the output of the client which is waiting for EPOLLOUT. When the
+     * output has drained, watch for its input again, and process it.
+     */
+    void flushClient(uint16_t index) {
+      Client& client = mClients[index];
+      if (! client.stream.flushOutput()) return;
+      client.writing = false;
+      watch(client.stream.getInFd(), index, EPOLL_CTL_MOD, EPOLLIN);
+      markPending(index);
+    }
+
+    /**
+     * Watch and process again as many starved clients as there are free line
+     * buffers, starting after the client which was retried last, so that
+     * every starved client gets its turn.
+     */
+    void retryStarved() {
+      uint8_t numFree = mBufferPool.getNumFree();
+      for (uint16_t i = 0; i < MAX_CLIENTS; i++) {
+        if (numFree == 0 || mNumStarved == 0) break;
+        uint16_t index = mNextStarved;
+        mNextStarved = (index + 1 < MAX_CLIENTS) ? index + 1 : 0;
+
+        Client& client = mClients[index];
+        if (! client.starved) continue;
+        client.starved = false;
+        mNumStarved--;
+        watch(client.stream.getInFd(), index);
+        markPending(index);
+        numFree--;
+      }
+    }
+
+    void removeClient(uint16_t index) {
+      Client& client = mClients[index];
+      int fd = client.stream.getInFd();
+      epoll_ctl(mEpollFd, EPOLL_CTL_DEL, fd, nullptr);
+      ::close(fd);
+      client.session.reset(mBufferPool);
+      mNumDroppedBytes += client.stream.getNumDropped();
+      client.stream.detach();
+      clearPending(index);
+      if (client.starved) {
+        client.starved = false;
+        mNumStarved--;
+      }
+      client.writing = false;
+      mNumClients--;
+    }
+
+  private:
+    // The free list must be declared before mBufferPool, which fills it.
+    uint8_t mFreeList[NUM_BUFFERS];
+    LineBufferPool mBufferPool;
+    CommandDispatcher mCommandDispatcher;
+    char mBuffers[NUM_BUFFERS][BUF_SIZE];
+    const char* mArgv[ARGV_SIZE];
+    char mTokens[BUF_SIZE];
+    Client mClients[MAX_CLIENTS];
+
+    int mEpollFd = -1;
+    int mListenFd = -1;
+    uint16_t mNumClients = 0;
+    uint16_t mNumPending = 0;
+    uint16_t mNumStarved = 0;
+    uint16_t mNextStarved = 0;
+    uint32_t mNumAccepted = 0;
+    uint32_t mNumRejected = 0;
+    uint32_t mNumDroppedBytes = 0;
+};
+
+} // cli
+} // ace_utils
+
+#endif
+
+#endif
@@ -0,0 +1,164 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#if defined(EPOXY_DUINO)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h> // memcpy(), memmove()
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include "FdStream.h"
+
+#if ! defined(MSG_NOSIGNAL)
+  #define MSG_NOSIGNAL 0 // MacOS
+#endif
+
+namespace ace_utils {
+namespace cli {
+
+static void setNonBlocking(int fd) {
+  int flags = fcntl(fd, F_GETFL, 0);
+  if (flags >= 0) fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+void FdStream::attach(int inFd, int outFd) {
+  mInFd = inFd;
+  mOutFd = outFd;
+  mPos = mLen = 0;
+  mOutPos = mOutLen = 0;
+  mEof = false;
+  mNumDropped = 0;
+  setNonBlocking(inFd);
+  if (outFd != inFd) setNonBlocking(outFd);
+
+  struct stat st;
+  mIsSocket = fstat(outFd, &st) == 0 && S_ISSOCK(st.st_mode);
+}
+
+void FdStream::detach() {
+  mInFd = mOutFd = -1;
+  mPos = mLen = 0;
+  mOutPos = mOutLen = 0;
+  mEof = false;
+}
+
+int FdStream::available() {
+  // Stop reading the input while the output is backed up.
+  if (mPos == mLen && mInFd >= 0 && ! mEof && ! hasPendingOutput()) {
+    ssize_t n = ::read(mInFd, mBuf, kBufferSize);
+    if (n > 0) {
+      mPos = 0;
+      mLen = n;
+    } else if (n == 0
+        || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+      mEof = true;
+    }
+  }
+  return mLen - mPos;
+}
+
+int FdStream::read() {
+  if (available() == 0) return -1;
+  return mBuf[mPos++];
+}
+
+int FdStream::peek() {
+  if (available() == 0) return -1;
+  return mBuf[mPos];
+}
+
+ssize_t FdStream::writeFd(const uint8_t* buffer, size_t size) {
+  size_t n = 0;
+  while (n < size) {
+    ssize_t written = mIsSocket
+        ? ::send(mOutFd, buffer + n, size - n, MSG_NOSIGNAL)
+        : ::write(mOutFd, buffer + n, size - n);
+    if (written > 0) {
+      n += written;
+    } else if (written < 0 && errno == EINTR) {
+      continue;
+    } else if (written < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+      return -1;
+    } else {
+      break;
+    }
+  }
+  return n;
+}
+
+size_t FdStream::write(const uint8_t* buffer, size_t size) {
+  if (mOutFd < 0) return 0;
+
+  // Keep the order of the output, by writing directly only if nothing is
+  // waiting in the output buffer.
+  size_t n = 0;
+  if (! hasPendingOutput()) {
+    ssize_t written = writeFd(buffer, size);
+    if (written < 0) {
+      mNumDropped += size;
+      return 0;
+    }
+    n = written;
+    if (n == size) return n;
+  }
+
+  // Buffer the rest, moving the unsent bytes to the front if necessary.
+  if (mOutLen + (size - n) > kOutputSize && mOutPos > 0) {
+    memmove(mOutBuf, mOutBuf + mOutPos, mOutLen - mOutPos);
+    mOutLen -= mOutPos;
+    mOutPos = 0;
+  }
+  size_t room = kOutputSize - mOutLen;
+  size_t numBuffered = (size - n < room) ? size - n : room;
+  memcpy(mOutBuf + mOutLen, buffer + n, numBuffered);
+  mOutLen += numBuffered;
+  n += numBuffered;
+
+  mNumDropped += size - n;
+  return n;
+}
+
+bool FdStream::flushOutput() {
+  if (! hasPendingOutput()) return true;
+  if (mOutFd < 0) return false;
+
+  ssize_t written = writeFd(mOutBuf + mOutPos, mOutLen - mOutPos);
+  if (written < 0) {
+    // The descriptor is broken, so the output can never be sent.
+    mNumDropped += mOutLen - mOutPos;
+    mOutPos = mOutLen = 0;
+    return true;
+  }
+  mOutPos += written;
+  if (mOutPos < mOutLen) return false;
+  mOutPos = mOutLen = 0;
+  return true;
+}
+
+} // cli
+} // ace_utils
+
+#endif
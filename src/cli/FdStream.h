@@ -0,0 +1,149 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_FD_STREAM_H
+#define ACE_UTILS_CLI_FD_STREAM_H
+
+// Only on host builds, which have POSIX file descriptors.
+#if defined(EPOXY_DUINO)
+
+#include <stdint.h>
+#include <sys/types.h> // ssize_t
+#include <Arduino.h> // Stream
+
+namespace ace_utils {
+namespace cli {
+
+/**
+ * A Stream over a pair of non-blocking POSIX file descriptors (e.g. a
+ * Unix-domain socket, a pty master, or stdin and stdout), so that the
+ * processors can serve clients other than the emulated Serial port on
+ * EpoxyDuino. Available only if EPOXY_DUINO is defined.
+ *
+ * The input is read from the file descriptor in blocks of kBufferSize bytes
+ * when available() finds the internal buffer empty. When the peer closes its
+ * end, or a read error occurs, isEof() becomes true. The output is written
+ * without blocking. The bytes which the descriptor cannot accept yet are kept
+ * in an output buffer of kOutputSize bytes, sent by flushOutput(), and no
+ * more input is read from the descriptor until the output buffer is empty, so
+ * that a client which does not read its responses cannot make the server
+ * queue an unbounded amount of output. The bytes which do not fit into the
+ * output buffer, or which cannot be written because of an error, are dropped
+ * and counted in getNumDropped(). Writing to a socket whose peer has gone away
+ * does not raise SIGPIPE.
+ *
+ * The file descriptors are not owned by the FdStream, and are not closed by
+ * detach().
+ */
+class FdStream: public Stream {
+  public:
+    /** Size of the internal input buffer. */
+    static uint8_t const kBufferSize = 64;
+
+    /** Size of the internal output buffer. */
+    static uint16_t const kOutputSize = 256;
+
+    /** Constructor of a detached stream. */
+    FdStream() = default;
+
+    /**
+     * Start reading from 'inFd' and writing to 'outFd', which can be the same
+     * descriptor. Both are put into non-blocking mode.
+     */
+    void attach(int inFd, int outFd);
+
+    /**
+     * Stop using the file descriptors, and discard the buffered input and
+     * output.
+     */
+    void detach();
+
+    /** Return the input file descriptor, or -1 if detached. */
+    int getInFd() const { return mInFd; }
+
+    /** Return true if the peer closed its end, or a read failed. */
+    bool isEof() const { return mEof; }
+
+    /** Return true if the internal buffer holds unread bytes. */
+    bool hasBuffered() const { return mPos < mLen; }
+
+    /** Return true if the output buffer holds unsent bytes. */
+    bool hasPendingOutput() const { return mOutPos < mOutLen; }
+
+    /**
+     * Send the bytes of the output buffer which the descriptor accepts without
+     * blocking. Return true if the output buffer is empty afterwards.
+     */
+    bool flushOutput();
+
+    /** Return the number of output bytes dropped. */
+    uint32_t getNumDropped() const { return mNumDropped; }
+
+    int available() override;
+
+    int read() override;
+
+    int peek() override;
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+
+    size_t write(const uint8_t* buffer, size_t size) override;
+
+    using Print::write;
+
+    /** Same as flushOutput(), does not block. */
+    void flush() override { flushOutput(); }
+
+  private:
+    // Disable copy-constructor and assignment operator
+    FdStream(const FdStream&) = delete;
+    FdStream& operator=(const FdStream&) = delete;
+
+    /**
+     * Write 'size' bytes to the output descriptor. Return the number of bytes
+     * written, or -1 if the descriptor failed with an error other than
+     * EAGAIN.
+     */
+    ssize_t writeFd(const uint8_t* buffer, size_t size);
+
+  private:
+    int mInFd = -1;
+    int mOutFd = -1;
+    uint32_t mNumDropped = 0;
+    uint8_t mBuf[kBufferSize];
+    uint8_t mOutBuf[kOutputSize];
+    uint16_t mOutPos = 0;
+    uint16_t mOutLen = 0;
+    uint8_t mPos = 0;
+    uint8_t mLen = 0;
+    bool mEof = false;
+    bool mIsSocket = false;
+};
+
+} // cli
+} // ace_utils
+
+#endif
+
+#endif
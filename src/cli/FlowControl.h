@@ -0,0 +1,181 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_FLOW_CONTROL_H
+#define ACE_UTILS_CLI_FLOW_CONTROL_H
+
+#include <Arduino.h> // Print
+#include "BufferedPrint.h"
+
+namespace ace_utils {
+namespace cli {
+
+/**
+ * A hook which tells the host to stop sending (busy) and to resume sending
+ * (ready), so that the host can stream commands at full speed without
+ * overflowing the receive buffer of the Stream while a command runs. The
+ * processors (DirectProcessor, StreamProcessorCoroutine and
+ * StreamReaderCoroutine) call update() with the number of bytes waiting in
+ * the Stream, and whether the input is held by a command.
+ *
+ * The host is told to stop when any of the following is true:
+ *
+ *  * the number of bytes waiting in the Stream reaches 'highWater',
+ *  * a command is about to run while more input is waiting, either in the
+ *    Stream or in the line buffer of the processor,
+ *  * a long-running command is running (see CommandHandler::poll()),
+ *  * the optional BufferedPrint holds at least 'maxPending' bytes.
+ *
+ * The host is told to resume when none of these is true, and the number of
+ * waiting bytes has dropped to 'lowWater'. The 'highWater' should leave room
+ * in the receive buffer of the Stream (e.g. 64 bytes for the hardware Serial
+ * of an AVR) for the bytes which are already in flight when the host reacts.
+ *
+ * Flow control does not help with a single line which is longer than the
+ * line buffer. Such a line is still discarded until the next newline.
+ *
+ * This is an abstract class. Use XonXoffFlowControl, or implement setReady()
+ * to control a hardware handshake line, e.g. an RTS pin.
+ */
+class FlowControl {
+  public:
+    /**
+     * Constructor.
+     *
+     * @param highWater number of bytes waiting in the Stream which tells the
+     *        host to stop
+     * @param lowWater number of bytes waiting in the Stream which tells the
+     *        host to resume, should be smaller than highWater
+     */
+    FlowControl(uint8_t highWater, uint8_t lowWater):
+        mHighWater(highWater),
+        mLowWater(lowWater)
+    {}
+
+    /**
+     * Also tell the host to stop when the given BufferedPrint holds at least
+     * 'maxPending' bytes. Pass nullptr to disable.
+     */
+    void setOutput(const BufferedPrint* output, uint16_t maxPending) {
+      mOutput = output;
+      mMaxPending = maxPending;
+    }
+
+    /**
+     * Update the state of the flow control. Called by the processors.
+     *
+     * @param available number of bytes waiting in the Stream
+     * @param busy true if the processor is not reading its input, e.g.
+     *        while a command is running with more input waiting
+     */
+    void update(int available, bool busy) {
+      bool outputFull = mOutput != nullptr
+          && mOutput->getNumPending() >= mMaxPending;
+      if (busy || outputFull || available >= mHighWater) {
+        pause();
+      } else if (available <= mLowWater) {
+        resume();
+      }
+    }
+
+    /** Return true if the host was told to stop sending. */
+    bool isPaused() const { return mPaused; }
+
+    /** Return the number of times the host was told to stop sending. */
+    uint16_t getNumPauses() const { return mNumPauses; }
+
+  protected:
+    /**
+     * Tell the host to resume (ready is true) or stop (ready is false)
+     * sending. Called only when the state changes.
+     */
+    virtual void setReady(bool ready) = 0;
+
+  private:
+    // Disable copy-constructor and assignment operator
+    FlowControl(const FlowControl&) = delete;
+    FlowControl& operator=(const FlowControl&) = delete;
+
+    void pause() {
+      if (mPaused) return;
+      mPaused = true;
+      if (mNumPauses < UINT16_MAX) mNumPauses++;
+      setReady(false);
+    }
+
+    void resume() {
+      if (! mPaused) return;
+      mPaused = false;
+      setReady(true);
+    }
+
+  private:
+    const BufferedPrint* mOutput = nullptr;
+    uint16_t mMaxPending = 0;
+    uint16_t mNumPauses = 0;
+    uint8_t const mHighWater;
+    uint8_t const mLowWater;
+    bool mPaused = false;
+};
+
+/**
+ * Software flow control which writes the XOFF (Ctrl-S) and XON (Ctrl-Q)
+ * characters to the host. The 'printer' should be the Stream itself, not a
+ * BufferedPrint, so that the XOFF is not queued behind the output of the
+ * commands. The host must be configured to honor XON/XOFF, and the commands
+ * should not print these 2 characters themselves.
+ */
+class XonXoffFlowControl: public FlowControl {
+  public:
+    /** The XON character, Ctrl-Q. */
+    static uint8_t const kXon = 0x11;
+
+    /** The XOFF character, Ctrl-S. */
+    static uint8_t const kXoff = 0x13;
+
+    /**
+     * Constructor.
+     *
+     * @param printer output to the host, normally the same as the Stream
+     * @param highWater see FlowControl
+     * @param lowWater see FlowControl
+     */
+    XonXoffFlowControl(Print& printer, uint8_t highWater, uint8_t lowWater):
+        FlowControl(highWater, lowWater),
+        mPrinter(printer)
+    {}
+
+  protected:
+    void setReady(bool ready) override {
+      mPrinter.write(ready ? kXon : kXoff);
+    }
+
+  private:
+    Print& mPrinter;
+};
+
+} // cli
+} // ace_utils
+
+#endif
@@ -0,0 +1,390 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_FRAME_PROCESSOR_H
+#define ACE_UTILS_CLI_FRAME_PROCESSOR_H
+
+#include <string.h> // memchr()
+#include <Arduino.h> // Stream, Print, strcpy_P()
+#include <AceCRC.h> // crc16ccitt_nibble
+#include "ArgSchema.h"
+#include "BinaryFrame.h"
+#include "CommandDispatcher.h"
+
+namespace ace_utils {
+namespace cli {
+
+/**
+ * A Print which collects the output of a CommandHandler into the body of a
+ * response frame of the binary protocol. Output which does not fit is
+ * discarded, and the response is marked as BinaryFrame::kStatusTruncated.
+ */
+class FrameResponse: public Print {
+  public:
+    /**
+     * Constructor.
+     *
+     * @param buffer storage for the decoded response frame
+     * @param bufferSize size of the buffer, which includes the 2-byte header
+     *        and the 2-byte CRC
+     */
+    FrameResponse(uint8_t* buffer, uint8_t bufferSize) :
+        mBuf(buffer),
+        mBufSize(bufferSize)
+    {}
+
+    /** Start a new response for the given request id. */
+    void begin(uint8_t reqId) {
+      mBuf[0] = reqId;
+      mLen = kHeaderSize;
+      mTruncated = false;
+    }
+
+    size_t write(uint8_t c) override {
+      if (mLen >= mBufSize - kCrcSize) {
+        mTruncated = true;
+        return 0;
+      }
+      mBuf[mLen++] = c;
+      return 1;
+    }
+
+    using Print::write;
+
+    /**
+     * Finish the response with the given status (which is replaced with
+     * kStatusTruncated if the output overflowed), append the CRC, and write
+     * the encoded frame to the printer.
+     */
+    void end(Print& printer, uint8_t status) {
+      if (status == BinaryFrame::kStatusOk && mTruncated) {
+        status = BinaryFrame::kStatusTruncated;
+      }
+      mBuf[1] = status;
+      uint16_t crc = ace_crc::crc16ccitt_nibble::crc_calculate(mBuf, mLen);
+      mBuf[mLen++] = crc >> 8;
+      mBuf[mLen++] = crc & 0xFF;
+      BinaryFrame::encode(printer, mBuf, mLen);
+    }
+
+  private:
+    // Disable copy-constructor and assignment operator
+    FrameResponse(const FrameResponse&) = delete;
+    FrameResponse& operator=(const FrameResponse&) = delete;
+
+    static uint8_t const kHeaderSize = 2;
+    static uint8_t const kCrcSize = 2;
+
+    uint8_t* const mBuf;
+    uint8_t const mBufSize;
+    uint8_t mLen = 0;
+    bool mTruncated = false;
+};
+
+/**
+ * Read frames of the binary protocol described in BinaryFrame from the Stream
+ * device, and run the CommandHandler identified by the cmdId of each frame.
+ * The same CommandHandler array can be served as text by another processor
+ * (e.g. DirectProcessor) on a different Stream, so that each command is
+ * reachable as text or binary.
+ *
+ * The binary arguments are first decoded into the `values` and `types`
+ * arrays, and given to CommandHandler::runTyped() (e.g. a
+ * SchemaCommandHandler), so that the integers are used without any text
+ * conversion. If the command accepts only text, the arguments are converted
+ * into the usual argv array instead, so the CommandHandler does not need to
+ * know which protocol was used. String arguments point directly into the
+ * frame buffer. Integer arguments are formatted into the `numbers` buffer,
+ * which needs up to 12 bytes per integer. The argv[0] is the name of the
+ * command. If the name is stored in flash memory, it is copied into the front
+ * of the `numbers` buffer. The `numbers` buffer can be empty if every command
+ * which takes integer arguments, or has a name in flash memory, implements
+ * runTyped().
+ *
+ * The response of each request carries its reqId, so the host can send
+ * several requests without waiting for each response. The requests are
+ * processed in order. A long-running command (see CommandHandler::poll()) is
+ * polled on each call to process(), and the next frames are not read until
+ * it has finished and its response has been sent.
+ */
+class FrameProcessor {
+  public:
+    /**
+     * Constructor.
+     *
+     * @param stream input stream
+     * @param commandDispatcher CommandDispatcher which holds the commands
+     * @param printer output stream, often the same as `stream`
+     * @param frameBuffer buffer for an encoded request frame
+     * @param frameSize size of frameBuffer. A longer frame is discarded.
+     * @param responseBuffer buffer for a decoded response frame
+     * @param responseSize size of responseBuffer
+     * @param argv array to hold the arguments
+     * @param argvSize size of argv
+     * @param values array of argvSize elements to hold the typed arguments
+     * @param types array of argvSize elements to hold the ArgSpec::kTypeXxx
+     *        of each typed argument
+     * @param numbers buffer to hold the command name stored in flash memory,
+     *        and the text of the integer arguments
+     * @param numbersSize size of numbers
+     */
+    FrameProcessor(
+        Stream& stream,
+        const CommandDispatcher& commandDispatcher,
+        Print& printer,
+        uint8_t* frameBuffer,
+        uint8_t frameSize,
+        uint8_t* responseBuffer,
+        uint8_t responseSize,
+        const char** argv,
+        uint8_t argvSize,
+        ArgValue* values,
+        uint8_t* types,
+        char* numbers,
+        uint16_t numbersSize
+    ):
+        mCommandDispatcher(commandDispatcher),
+        mStream(stream),
+        mPrinter(printer),
+        mResponse(responseBuffer, responseSize),
+        mFrame(frameBuffer),
+        mArgv(argv),
+        mValues(values),
+        mTypes(types),
+        mNumbers(numbers),
+        mFrameSize(frameSize),
+        mArgvSize(argvSize),
+        mNumbersSize(numbersSize)
+    {}
+
+    /**
+     * Read all the bytes which are available from the input stream, and
+     * handle each complete frame. If a long-running command is active, poll
+     * it instead, and return until it finishes.
+     */
+    void process() {
+      if (mActiveCommand != nullptr) {
+        if (! finishActiveCommand()) return;
+      }
+
+      while (mStream.available() > 0) {
+        uint8_t c = mStream.read();
+        if (c != 0) {
+          if (mLen < mFrameSize) {
+            mFrame[mLen++] = c;
+          } else {
+            mOverflow = true;
+          }
+          continue;
+        }
+
+        if (mOverflow) {
+          mCommandDispatcher.recordOverflow();
+          mNumFrameErrors++;
+        } else if (mLen > 0) {
+          handleFrame();
+        }
+        mLen = 0;
+        mOverflow = false;
+        if (mActiveCommand != nullptr) return;
+      }
+    }
+
+    /**
+     * Return the number of frames which were discarded without a response,
+     * because they overflowed the frame buffer or were not valid COBS.
+     */
+    uint16_t getNumFrameErrors() const { return mNumFrameErrors; }
+
+  private:
+    // Disable copy-constructor and assignment operator
+    FrameProcessor(const FrameProcessor&) = delete;
+    FrameProcessor& operator=(const FrameProcessor&) = delete;
+
+    void handleFrame() {
+      int16_t len = BinaryFrame::decode(mFrame, mLen);
+      if (len < 4) {
+        mNumFrameErrors++;
+        return;
+      }
+
+      uint8_t reqId = mFrame[0];
+      uint8_t bodyLen = len - 2;
+      uint16_t crc = (mFrame[bodyLen] << 8) | mFrame[bodyLen + 1];
+      mResponse.begin(reqId);
+      if (ace_crc::crc16ccitt_nibble::crc_calculate(mFrame, bodyLen) != crc) {
+        mResponse.end(mPrinter, BinaryFrame::kStatusCrcError);
+        return;
+      }
+
+      const CommandHandler* command = mCommandDispatcher.getCommand(mFrame[1]);
+      if (command == nullptr) {
+        mCommandDispatcher.recordUnknownCommand();
+        mResponse.end(mPrinter, BinaryFrame::kStatusUnknownCommand);
+        return;
+      }
+
+      int numArgs = decodeArgs(mFrame + 2, bodyLen - 2);
+      if (numArgs < 0) {
+        mResponse.end(mPrinter, BinaryFrame::kStatusBadArgs);
+        return;
+      }
+
+      if (! mCommandDispatcher.runTypedHandler(
+          mResponse, command, numArgs, mValues, mTypes)) {
+        int argc = formatArgs(command, numArgs);
+        if (argc < 0) {
+          mResponse.end(mPrinter, BinaryFrame::kStatusBadArgs);
+          return;
+        }
+        mCommandDispatcher.runHandler(mResponse, command, argc, mArgv);
+      }
+      mActiveCommand = command;
+      finishActiveCommand();
+    }
+
+    /**
+     * Poll the active command. When it has finished, send its response as a
+     * single frame, and return true.
+     */
+    bool finishActiveCommand() {
+      if (! mCommandDispatcher.pollHandler(mResponse, mActiveCommand)) {
+        return false;
+      }
+      mActiveCommand = nullptr;
+      mResponse.end(mPrinter, BinaryFrame::kStatusOk);
+      return true;
+    }
+
+    /**
+     * Decode the binary arguments into mValues and mTypes. Return the number
+     * of arguments, or -1 if the arguments are malformed or do not fit.
+     */
+    int decodeArgs(uint8_t* args, uint8_t len) {
+      uint8_t numArgs = 0;
+      uint8_t i = 0;
+      while (i < len) {
+        if (numArgs + 1 >= mArgvSize) return -1;
+        uint8_t type = args[i++];
+        if (type == BinaryFrame::kArgString) {
+          char* s = (char*) args + i;
+          const char* end = (const char*) memchr(s, '\0', len - i);
+          if (end == nullptr) return -1;
+          mTypes[numArgs] = ArgSpec::kTypeString;
+          mValues[numArgs].s = s;
+          i += end - s + 1;
+        } else if (type == BinaryFrame::kArgInt32) {
+          if (len - i < 4) return -1;
+          mTypes[numArgs] = ArgSpec::kTypeInt;
+          mValues[numArgs].i = (uint32_t) args[i]
+              | ((uint32_t) args[i + 1] << 8)
+              | ((uint32_t) args[i + 2] << 16)
+              | ((uint32_t) args[i + 3] << 24);
+          i += 4;
+        } else {
+          return -1;
+        }
+        numArgs++;
+      }
+      return numArgs;
+    }
+
+    /**
+     * Convert the decoded arguments into the text of mArgv, for a command
+     * which does not implement runTyped(). Return the argc, or -1 if the text
+     * does not fit into mNumbers.
+     */
+    int formatArgs(const CommandHandler* command, uint8_t numArgs) {
+      uint16_t numbersLen = 0;
+      ace_common::FCString name = command->getName();
+      if (name.getType() == ace_common::FCString::kCStringType) {
+        mArgv[0] = name.getCString();
+      } else {
+        const char* fname = (const char*) name.getFString();
+        numbersLen = strlen_P(fname) + 1;
+        if (numbersLen > mNumbersSize) return -1;
+        strcpy_P(mNumbers, fname);
+        mArgv[0] = mNumbers;
+      }
+
+      for (uint8_t i = 0; i < numArgs; i++) {
+        if (mTypes[i] == ArgSpec::kTypeString) {
+          mArgv[i + 1] = mValues[i].s;
+        } else {
+          if (mNumbersSize - numbersLen < kMaxInt32Len) return -1;
+          char* s = mNumbers + numbersLen;
+          numbersLen += formatInt32(s, mValues[i].i) + 1;
+          mArgv[i + 1] = s;
+        }
+      }
+      return numArgs + 1;
+    }
+
+    /**
+     * Write the decimal representation of value into 's', NUL-terminated.
+     * Return the number of characters, excluding the NUL.
+     */
+    static uint8_t formatInt32(char* s, int32_t value) {
+      uint32_t u = (value < 0) ? -(uint32_t) value : value;
+      char digits[10];
+      uint8_t numDigits = 0;
+      do {
+        digits[numDigits++] = '0' + (u % 10);
+        u /= 10;
+      } while (u != 0);
+
+      uint8_t len = 0;
+      if (value < 0) s[len++] = '-';
+      while (numDigits > 0) s[len++] = digits[--numDigits];
+      s[len] = '\0';
+      return len;
+    }
+
+  private:
+    /** Longest int32 string "-2147483648", including the NUL. */
+    static uint8_t const kMaxInt32Len = 12;
+
+    const CommandDispatcher& mCommandDispatcher;
+    Stream& mStream;
+    Print& mPrinter;
+    FrameResponse mResponse;
+    uint8_t* const mFrame;
+    const char** const mArgv;
+    ArgValue* const mValues;
+    uint8_t* const mTypes;
+    char* const mNumbers;
+    uint8_t const mFrameSize;
+    uint8_t const mArgvSize;
+    uint16_t const mNumbersSize;
+
+    const CommandHandler* mActiveCommand = nullptr;
+    uint8_t mLen = 0;
+    bool mOverflow = false;
+    uint16_t mNumFrameErrors = 0;
+};
+
+} // cli
+} // ace_utils
+
+#endif
@@ -0,0 +1,139 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_FRAME_PROCESSOR_MANAGER_H
+#define ACE_UTILS_CLI_FRAME_PROCESSOR_MANAGER_H
+
+#include "CommandDispatcher.h"
+#include "FrameProcessor.h"
+
+namespace ace_utils {
+namespace cli {
+
+/**
+ * A convenience wrapper around a FrameProcessor that creates the
+ * CommandDispatcher and the buffers needed by the binary frame protocol. This
+ * is not included by `cli.h` because it depends on the AceCRC library.
+ *
+ * Example usage:
+ *
+ * @code
+ * #include <cli/FrameProcessorManager.h>
+ *
+ * const uint8_t FRAME_SIZE = 64;
+ * const uint8_t ARGV_SIZE = 5;
+ * const uint8_t RESPONSE_SIZE = 64;
+ *
+ * FrameProcessorManager<FRAME_SIZE, ARGV_SIZE, RESPONSE_SIZE> frameManager(
+ *     Serial1, COMMANDS, NUM_COMMANDS, Serial1);
+ *
+ * void loop() {
+ *   frameManager.process();
+ * }
+ * @endcode
+ *
+ * @param FRAME_SIZE Size of the encoded request frame buffer.
+ * @param ARGV_SIZE Size of the argv list, including the command itself.
+ * @param RESPONSE_SIZE Size of the decoded response frame buffer, which
+ *        includes 4 bytes of header and CRC.
+ * @param NUMBERS_SIZE Size of the buffer for the text of the integer
+ *        arguments and of a command name stored in flash memory, used only
+ *        for the commands which do not implement CommandHandler::runTyped().
+ *        The default reserves 12 bytes for each argument, plus 16 bytes for
+ *        the name. Can be 0 if all such commands are SchemaCommandHandler, in
+ *        which case a request with an integer argument for any other command
+ *        is answered with BinaryFrame::kStatusBadArgs.
+ */
+template<uint8_t FRAME_SIZE, uint8_t ARGV_SIZE, uint8_t RESPONSE_SIZE,
+    uint16_t NUMBERS_SIZE = 16 + (ARGV_SIZE - 1) * 12>
+class FrameProcessorManager {
+  public:
+    /**
+     * Constructor.
+     *
+     * @param stream The input stream of frames.
+     * @param commands Array of (CommandHandler*). The cmdId of a frame is the
+     *        index into this array.
+     * @param numCommands Number of commands in 'commands'.
+     * @param printer output stream, often the same as `stream`
+     */
+    FrameProcessorManager(
+        Stream& stream,
+        const CommandHandler* const* commands,
+        uint8_t numCommands,
+        Print& printer
+    ) :
+        mCommandDispatcher(commands, numCommands, mArgv, ARGV_SIZE),
+        mFrameProcessor(stream, mCommandDispatcher, printer,
+            mFrameBuffer, FRAME_SIZE, mResponseBuffer, RESPONSE_SIZE,
+            mArgv, ARGV_SIZE, mValues, mTypes, mNumbers, NUMBERS_SIZE)
+    {}
+
+    /** Handle the frames which are available on the stream. */
+    void process() {
+      mFrameProcessor.process();
+    }
+
+    /** Return the FrameProcessor. */
+    FrameProcessor& getFrameProcessor() {
+      return mFrameProcessor;
+    }
+
+    /**
+     * Return the underlying CommandDispatcher, e.g. to create a BoundCommand
+     * or to give it to a WatchManager.
+     */
+    const CommandDispatcher& getCommandDispatcher() const {
+      return mCommandDispatcher;
+    }
+
+    /**
+     * Give the ScratchArena to the commands, see
+     * CommandDispatcher::setScratchArena().
+     */
+    void setScratchArena(ScratchArena* arena) {
+      mCommandDispatcher.setScratchArena(arena);
+    }
+
+  private:
+    // Disable copy-constructor and assignment operator
+    FrameProcessorManager(const FrameProcessorManager&) = delete;
+    FrameProcessorManager& operator=(const FrameProcessorManager&) = delete;
+
+  private:
+    CommandDispatcher mCommandDispatcher;
+    FrameProcessor mFrameProcessor;
+    uint8_t mFrameBuffer[FRAME_SIZE];
+    uint8_t mResponseBuffer[RESPONSE_SIZE];
+    const char* mArgv[ARGV_SIZE];
+    ArgValue mValues[ARGV_SIZE];
+    uint8_t mTypes[ARGV_SIZE];
+    // An array cannot have a size of 0.
+    char mNumbers[(NUMBERS_SIZE > 0) ? NUMBERS_SIZE : 1];
+};
+
+} // cli
+} // ace_utils
+
+#endif
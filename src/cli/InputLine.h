@@ -30,15 +30,15 @@ namespace cli {
 
 /**
  * Message sent from StreamReaderCoroutine to CommandDispatcher coroutines
- * through Channel<InputLine> channel. Represents a line typed by a user into
- * the Serial port.
+ * through Channel<InputLine> channel, or from QueueReaderCoroutine through a
+ * LineQueue. Represents a line typed by a user into the Serial port.
  */
 struct InputLine {
   static uint8_t const kStatusOk = 0;
   static uint8_t const kStatusOverflow = 1;
 
   uint8_t status;
-  char* line; // will be modified in-situ by strtok()
+  char* line; // restored by CommandDispatcher after the command runs
 };
 
 } // cli
@@ -0,0 +1,73 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <Arduino.h> // Print, F()
+#include "JitterCommand.h"
+
+namespace ace_utils {
+namespace cli {
+
+JitterCommand::JitterCommand(LoopJitter& loopJitter):
+    CommandHandler(F("jitter"), F("[reset]")),
+    mLoopJitter(loopJitter)
+{}
+
+void JitterCommand::run(Print& printer, int argc, const char* const* argv)
+    const {
+  if (argc == 2 && isArgEqual(argv[1], F("reset"))) {
+    mLoopJitter.reset();
+    return;
+  }
+
+  printer.println(F("Gap(us): count"));
+  for (uint8_t i = 0; i < LoopJitter::kNumBuckets; i++) {
+    uint16_t count = mLoopJitter.getCount(i);
+    if (count == 0) continue;
+    printer.print(F("  >="));
+    printer.print((i == 0) ? 0UL : (1UL << i));
+    printer.print(F(": "));
+    printer.println(count);
+  }
+  printer.print(F("Max(us): "));
+  printer.println(mLoopJitter.getMaxGapMicros());
+
+  uint16_t numOutliers = mLoopJitter.getNumOutliers();
+  printer.print(F("Outliers(>"));
+  printer.print(mLoopJitter.getOutlierMicros());
+  printer.print(F("us): "));
+  printer.println(numOutliers);
+  if (numOutliers > LoopJitter::kNumOutliers) {
+    numOutliers = LoopJitter::kNumOutliers;
+  }
+  for (uint8_t i = 0; i < numOutliers; i++) {
+    const LoopJitter::Outlier& outlier = mLoopJitter.getOutlier(i);
+    printer.print(F("  "));
+    printer.print(outlier.gapMicros);
+    printer.print(F("us: "));
+    printer.println(outlier.tag ? outlier.tag : "-");
+  }
+}
+
+} // cli
+} // ace_utils
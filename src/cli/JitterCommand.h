@@ -0,0 +1,58 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_JITTER_COMMAND_H
+#define ACE_UTILS_CLI_JITTER_COMMAND_H
+
+#include "CommandHandler.h"
+#include "LoopJitter.h"
+
+namespace ace_utils {
+namespace cli {
+
+/**
+ * A CommandHandler which prints the histogram and the outliers of a
+ * LoopJitter. The `jitter reset` command clears them.
+ */
+class JitterCommand: public CommandHandler {
+  public:
+    /** Constructor. */
+    explicit JitterCommand(LoopJitter& loopJitter);
+
+    void run(Print& printer, int argc, const char* const* argv)
+        const override;
+
+  private:
+    // Disable copy-constructor and assignment operator
+    JitterCommand(const JitterCommand&) = delete;
+    JitterCommand& operator=(const JitterCommand&) = delete;
+
+  private:
+    LoopJitter& mLoopJitter;
+};
+
+} // cli
+} // ace_utils
+
+#endif
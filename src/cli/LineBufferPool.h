@@ -0,0 +1,117 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_LINE_BUFFER_POOL_H
+#define ACE_UTILS_CLI_LINE_BUFFER_POOL_H
+
+#include <stdint.h>
+
+namespace ace_utils {
+namespace cli {
+
+/**
+ * A fixed-size pool of line buffers of identical size, shared by multiple
+ * SessionProcessor instances. A session acquires a buffer when bytes arrive
+ * on its Stream, and releases it when it has no partial line left. The free
+ * buffers are tracked using a stack of buffer indexes.
+ */
+class LineBufferPool {
+  public:
+    /**
+     * Constructor.
+     *
+     * @param buffers storage for `numBuffers` buffers of `bufferSize` bytes
+     *        each, laid out contiguously (e.g. `char buffers[N][SIZE]`)
+     * @param bufferSize size of each buffer
+     * @param numBuffers number of buffers
+     * @param freeList array of `numBuffers` elements used to hold the indexes
+     *        of the free buffers
+     */
+    LineBufferPool(
+        char* buffers,
+        uint8_t bufferSize,
+        uint8_t numBuffers,
+        uint8_t* freeList
+    ) :
+        mBuffers(buffers),
+        mBufferSize(bufferSize),
+        mNumBuffers(numBuffers),
+        mFreeList(freeList),
+        mNumFree(numBuffers)
+    {
+      for (uint8_t i = 0; i < numBuffers; i++) {
+        mFreeList[i] = numBuffers - 1 - i;
+      }
+    }
+
+    /** Return a free buffer, or nullptr if all of them are in use. */
+    char* acquire() {
+      if (mNumFree == 0) {
+        mNumStarved++;
+        return nullptr;
+      }
+      mNumFree--;
+      uint8_t inUse = mNumBuffers - mNumFree;
+      if (inUse > mMaxInUse) mMaxInUse = inUse;
+      return mBuffers + (uint16_t) mFreeList[mNumFree] * mBufferSize;
+    }
+
+    /** Return the buffer obtained from acquire() back to the pool. */
+    void release(char* buffer) {
+      mFreeList[mNumFree] = (buffer - mBuffers) / mBufferSize;
+      mNumFree++;
+    }
+
+    /** Return the size of each buffer. */
+    uint8_t getBufferSize() const { return mBufferSize; }
+
+    /** Return the number of free buffers. */
+    uint8_t getNumFree() const { return mNumFree; }
+
+    /** Return the maximum number of buffers that were in use at once. */
+    uint8_t getMaxInUse() const { return mMaxInUse; }
+
+    /** Return the number of times that acquire() found no free buffer. */
+    uint16_t getNumStarved() const { return mNumStarved; }
+
+  private:
+    // Disable copy-constructor and assignment operator
+    LineBufferPool(const LineBufferPool&) = delete;
+    LineBufferPool& operator=(const LineBufferPool&) = delete;
+
+  private:
+    char* const mBuffers;
+    uint8_t const mBufferSize;
+    uint8_t const mNumBuffers;
+    uint8_t* const mFreeList;
+
+    uint8_t mNumFree;
+    uint8_t mMaxInUse = 0;
+    uint16_t mNumStarved = 0;
+};
+
+} // cli
+} // ace_utils
+
+#endif
@@ -0,0 +1,148 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_LINE_QUEUE_H
+#define ACE_UTILS_CLI_LINE_QUEUE_H
+
+#include <stdint.h>
+#include "InputLine.h"
+
+namespace ace_utils {
+namespace cli {
+
+/**
+ * A bounded single-producer, single-consumer queue of input lines, backed by
+ * `numSlots` rotating line buffers. Used by QueueReaderCoroutine to pass
+ * lines to QueueProcessorCoroutine, so that the reader can keep assembling the
+ * next lines while a slow command is being processed.
+ *
+ * The producer obtains the buffer of the next free slot using acquireSlot(),
+ * fills it, then commits it using push(). The consumer reads the oldest line
+ * using front() and releases its slot using pop(). If the queue is full, the
+ * producer is expected to discard the incoming line and call recordDrop().
+ */
+class LineQueue {
+  public:
+    /**
+     * Constructor.
+     *
+     * @param buffers storage for `numSlots` line buffers of `bufferSize`
+     *        bytes each, laid out contiguously (e.g. `char buffers[N][SIZE]`)
+     * @param bufferSize size of each line buffer
+     * @param numSlots number of slots in the queue
+     * @param statuses array of `numSlots` elements to hold the
+     *        InputLine::status of each line
+     */
+    LineQueue(
+        char* buffers,
+        uint8_t bufferSize,
+        uint8_t numSlots,
+        uint8_t* statuses
+    ) :
+        mBuffers(buffers),
+        mStatuses(statuses),
+        mBufferSize(bufferSize),
+        mNumSlots(numSlots)
+    {}
+
+    /** Return the size of each line buffer. */
+    uint8_t getBufferSize() const { return mBufferSize; }
+
+    /**
+     * Return the buffer of the next free slot, or nullptr if the queue is
+     * full. The slot becomes visible to the consumer only after push().
+     */
+    char* acquireSlot() const {
+      if (mDepth >= mNumSlots) return nullptr;
+      return slotBuffer(mHead);
+    }
+
+    /** Commit the slot returned by acquireSlot() with the given status. */
+    void push(uint8_t status) {
+      mStatuses[mHead] = status;
+      mHead = nextIndex(mHead);
+      mDepth++;
+      if (mDepth > mMaxDepth) mMaxDepth = mDepth;
+    }
+
+    /** Return true if there are no lines waiting to be processed. */
+    bool isEmpty() const { return mDepth == 0; }
+
+    /** Return the oldest line. Valid only if isEmpty() is false. */
+    InputLine front() const {
+      InputLine input;
+      input.status = mStatuses[mTail];
+      input.line = slotBuffer(mTail);
+      return input;
+    }
+
+    /** Release the slot of the oldest line. */
+    void pop() {
+      mTail = nextIndex(mTail);
+      mDepth--;
+    }
+
+    /** Record a line that was discarded because the queue was full. */
+    void recordDrop() { mNumDropped++; }
+
+    /** Return the number of lines waiting to be processed. */
+    uint8_t getDepth() const { return mDepth; }
+
+    /** Return the maximum number of lines that were waiting at once. */
+    uint8_t getMaxDepth() const { return mMaxDepth; }
+
+    /** Return the number of lines dropped because the queue was full. */
+    uint16_t getNumDropped() const { return mNumDropped; }
+
+  private:
+    // Disable copy-constructor and assignment operator
+    LineQueue(const LineQueue&) = delete;
+    LineQueue& operator=(const LineQueue&) = delete;
+
+    char* slotBuffer(uint8_t index) const {
+      return mBuffers + (uint16_t) index * mBufferSize;
+    }
+
+    uint8_t nextIndex(uint8_t index) const {
+      index++;
+      return (index >= mNumSlots) ? 0 : index;
+    }
+
+  private:
+    char* const mBuffers;
+    uint8_t* const mStatuses;
+    uint8_t const mBufferSize;
+    uint8_t const mNumSlots;
+
+    uint8_t mHead = 0;
+    uint8_t mTail = 0;
+    uint8_t mDepth = 0;
+    uint8_t mMaxDepth = 0;
+    uint16_t mNumDropped = 0;
+};
+
+} // cli
+} // ace_utils
+
+#endif
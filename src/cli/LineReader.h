@@ -0,0 +1,242 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_LINE_READER_H
+#define ACE_UTILS_CLI_LINE_READER_H
+
+#include <string.h> // memchr(), memmove()
+#include <Arduino.h> // Stream
+
+/**
+ * If set to 1, the line buffers of LineReader, and of the processors which use
+ * it (DirectProcessor, StreamProcessorCoroutine and their managers), can be
+ * larger than 255 bytes, at the cost of a few more bytes of RAM per reader.
+ */
+#ifndef ACE_UTILS_CLI_WIDE_LINES
+#define ACE_UTILS_CLI_WIDE_LINES 0
+#endif
+
+namespace ace_utils {
+namespace cli {
+
+/** The type of the size of a line buffer, see ACE_UTILS_CLI_WIDE_LINES. */
+#if ACE_UTILS_CLI_WIDE_LINES
+typedef uint16_t line_size_t;
+#else
+typedef uint8_t line_size_t;
+#endif
+
+/**
+ * A line buffer which is filled from a Stream in blocks, instead of a single
+ * byte at a time. Each call to fill() drains as many bytes as reported by
+ * Stream::available() (up to the free space in the buffer) using a single
+ * Stream::readBytes() call. The next() method then scans for the '\\n' or '\\r'
+ * terminator using memchr(), which is implemented in optimized assembly on
+ * AVR and vectorized on most host C libraries.
+ *
+ * The buffer may contain several lines after a single fill() (e.g. when a
+ * script is pasted into the terminal), and next() returns them one at a time.
+ * A line which does not fit inside the buffer is discarded until the next
+ * terminator.
+ *
+ * The bytes which follow a line can also be taken out of the buffer without
+ * looking for a terminator, using takePending(). This is used to pass the
+ * payload of a command (see CommandHandler::getPayloadSize()) in chunks.
+ *
+ * The buffer can be borrowed from a LineBufferPool and given back when the
+ * reader becomes idle, using setBuffer() and isIdle(). This allows the RAM used
+ * by the line buffers to scale with the number of active sessions instead of
+ * the number of Streams. See SessionProcessor.
+ *
+ * Typical usage:
+ *
+ * @code
+ * while (true) {
+ *   uint8_t status = lineReader.next();
+ *   if (status == LineReader::kStatusNone) {
+ *     if (lineReader.fill(stream) == 0) break;
+ *   } else if (status == LineReader::kStatusLine) {
+ *     doSomething(lineReader.getLine());
+ *   } else {
+ *     ...
+ *   }
+ * }
+ * @endcode
+ */
+class LineReader {
+  public:
+    /** No complete line in the buffer. Call fill() to get more. */
+    static uint8_t const kStatusNone = 0;
+
+    /** A complete line is available through getLine(). */
+    static uint8_t const kStatusLine = 1;
+
+    /** The line overflowed the buffer. Discarding until the terminator. */
+    static uint8_t const kStatusOverflow = 2;
+
+    /** The terminator of a previously overflowed line was found. */
+    static uint8_t const kStatusFlushed = 3;
+
+    /**
+     * Constructor.
+     *
+     * @param buffer input character buffer, can be null if setBuffer() is
+     *        called before fill()
+     * @param bufferSize size of the buffer. The longest line that can be read
+     *        is `bufferSize - 1` characters, because the terminator is
+     *        replaced with a NUL character.
+     */
+    LineReader(char* buffer, line_size_t bufferSize):
+        mBuf(buffer),
+        mBufSize(bufferSize)
+    {}
+
+    /**
+     * Read the bytes that are available from the stream into the free space
+     * of the buffer, using a single readBytes() call, but no more than
+     * 'maxBytes'. Return the number of bytes read.
+     */
+    uint8_t fill(Stream& stream, uint8_t maxBytes = 255) {
+      compact();
+      int n = stream.available();
+      if (n <= 0) return 0;
+      line_size_t room = mBufSize - mLen;
+      if (room > maxBytes) room = maxBytes;
+      if (n > room) n = room;
+      if (n == 0) return 0;
+      n = stream.readBytes(mBuf + mLen, n);
+      mLen += n;
+      return n;
+    }
+
+    /**
+     * Scan the buffer for the next terminator, and return one of the
+     * kStatusXxx codes. If kStatusLine is returned, the NUL-terminated line is
+     * available through getLine() until the next call to next() or fill().
+     */
+    uint8_t next() {
+      char* eol = findEol(mBuf + mScanned, mLen - mScanned);
+      if (eol != nullptr) {
+        *eol = '\0';
+        mLine = mStart;
+        mStart = mScanned = eol - mBuf + 1;
+        if (mFlushing) {
+          mFlushing = false;
+          return kStatusFlushed;
+        }
+        return kStatusLine;
+      }
+
+      mScanned = mLen;
+      if (mStart == 0 && mLen == mBufSize) {
+        // Buffer is full without a terminator. Discard its contents.
+        mLen = mScanned = 0;
+        if (! mFlushing) {
+          mFlushing = true;
+          return kStatusOverflow;
+        }
+      }
+      return kStatusNone;
+    }
+
+    /**
+     * Take up to 'maxBytes' of the unprocessed bytes from the buffer, without
+     * looking for a terminator. Set 'data' to the first byte, and return the
+     * number of bytes taken, which is 0 if the buffer has no unprocessed
+     * bytes. The bytes are valid until the next call to fill().
+     */
+    uint8_t takePending(char*& data, uint8_t maxBytes) {
+      line_size_t n = mLen - mStart;
+      if (n > maxBytes) n = maxBytes;
+      data = mBuf + mStart;
+      mStart += n;
+      if (mScanned < mStart) mScanned = mStart;
+      return n;
+    }
+
+    /** Return the line found by the most recent next(). */
+    char* getLine() const { return mBuf + mLine; }
+
+    /** Return true if there are unprocessed bytes in the buffer. */
+    bool hasPending() const { return mLen > mStart; }
+
+    /**
+     * Return true if the buffer holds no unprocessed bytes and no overflowed
+     * line is being flushed, so that the buffer can be released.
+     */
+    bool isIdle() const { return ! hasPending() && ! mFlushing; }
+
+    /** Return the current buffer. May be null. */
+    char* getBuffer() const { return mBuf; }
+
+    /**
+     * Replace the buffer. Any bytes in the previous buffer are discarded,
+     * along with the overflowed line being flushed, so this should normally
+     * be called only if isIdle() is true.
+     */
+    void setBuffer(char* buffer, line_size_t bufferSize) {
+      mBuf = buffer;
+      mBufSize = bufferSize;
+      mLen = mStart = mScanned = mLine = 0;
+      mFlushing = false;
+    }
+
+  private:
+    // Disable copy-constructor and assignment operator
+    LineReader(const LineReader&) = delete;
+    LineReader& operator=(const LineReader&) = delete;
+
+    /** Move the partial line at mStart to the beginning of the buffer. */
+    void compact() {
+      if (mStart == 0) return;
+      line_size_t len = mLen - mStart;
+      memmove(mBuf, mBuf + mStart, len);
+      mLen = len;
+      mScanned -= mStart;
+      mStart = 0;
+    }
+
+    /** Return pointer to the first '\\n' or '\\r', or nullptr. */
+    static char* findEol(char* s, size_t len) {
+      char* eol = (char*) memchr(s, '\n', len);
+      if (eol != nullptr) len = eol - s;
+      char* cr = (char*) memchr(s, '\r', len);
+      return (cr != nullptr) ? cr : eol;
+    }
+
+  private:
+    char* mBuf;
+    line_size_t mBufSize;
+
+    line_size_t mLen = 0; // number of bytes in the buffer
+    line_size_t mStart = 0; // start of the current (partial) line
+    line_size_t mScanned = 0; // bytes before this have no terminator
+    line_size_t mLine = 0; // start of the line returned by next()
+    bool mFlushing = false;
+};
+
+} // cli
+} // ace_utils
+
+#endif
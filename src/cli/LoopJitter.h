@@ -0,0 +1,174 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_LOOP_JITTER_H
+#define ACE_UTILS_CLI_LOOP_JITTER_H
+
+#include <stdint.h>
+#include <Arduino.h> // micros()
+
+namespace ace_utils {
+namespace cli {
+
+/**
+ * Measures the gap between successive iterations of the global loop() (or
+ * CoroutineScheduler::loop()) into a histogram of log2 buckets, to verify that
+ * the command line processors do not disturb the real-time parts of the
+ * application. Bucket 'i' counts the gaps in the range [2^i, 2^(i+1))
+ * microseconds (bucket 0 also counts the gaps of 0), and the last bucket
+ * counts everything above.
+ *
+ * The processors which are given a LoopJitter (see
+ * DirectProcessor::setLoopJitter(),
+ * StreamProcessorCoroutine::setLoopJitter() and
+ * ChannelProcessorCoroutine::setLoopJitter()) call markBusy() with their tag
+ * whenever they run a command. A gap larger than the outlier threshold is
+ * recorded along with the tag of the processor that was busy during that
+ * iteration (or null if none was), in a ring of the last kNumOutliers
+ * outliers.
+ *
+ * Usage:
+ *
+ * @code
+ * LoopJitter loopJitter(2000);
+ *
+ * void loop() {
+ *   loopJitter.tick();
+ *   CoroutineScheduler::loop();
+ * }
+ * @endcode
+ */
+class LoopJitter {
+  public:
+    /** Number of buckets in the histogram. */
+    static uint8_t const kNumBuckets = 16;
+
+    /** Number of outliers retained. */
+    static uint8_t const kNumOutliers = 4;
+
+    /** A gap above the outlier threshold. */
+    struct Outlier {
+      /** Gap between the 2 iterations in micros. */
+      uint32_t gapMicros;
+
+      /** Tag of the processor which was busy, or null. */
+      const char* tag;
+    };
+
+    /**
+     * Constructor.
+     *
+     * @param outlierMicros gaps larger than this are recorded as outliers
+     */
+    explicit LoopJitter(uint32_t outlierMicros = 1000):
+        mOutlierMicros(outlierMicros)
+    {}
+
+    /** Call once per iteration of the loop. */
+    void tick() {
+      uint32_t now = micros();
+      if (mStarted) record(now - mLastMicros);
+      mStarted = true;
+      mLastMicros = now;
+      mTag = nullptr;
+    }
+
+    /** Mark the current iteration as being used by the given processor. */
+    void markBusy(const char* tag) { mTag = tag; }
+
+    /** Clear the histogram and the outliers. */
+    void reset() {
+      for (uint8_t i = 0; i < kNumBuckets; i++) mCounts[i] = 0;
+      mNumOutliers = 0;
+      mOutlierHead = 0;
+      mMaxGapMicros = 0;
+      mStarted = false;
+    }
+
+    /** Return the number of gaps in the given bucket, saturated at 65535. */
+    uint16_t getCount(uint8_t bucket) const { return mCounts[bucket]; }
+
+    /** Return the largest gap since the last reset(). */
+    uint32_t getMaxGapMicros() const { return mMaxGapMicros; }
+
+    /** Return the outlier threshold. */
+    uint32_t getOutlierMicros() const { return mOutlierMicros; }
+
+    /** Return the total number of outliers since the last reset(). */
+    uint16_t getNumOutliers() const { return mNumOutliers; }
+
+    /**
+     * Return the i'th most recent outlier, where 0 is the latest. Valid for
+     * i < min(getNumOutliers(), kNumOutliers).
+     */
+    const Outlier& getOutlier(uint8_t i) const {
+      uint8_t index = (mOutlierHead + kNumOutliers - 1 - i) % kNumOutliers;
+      return mOutliers[index];
+    }
+
+    /** Return the bucket of the given gap. VisibleForTesting. */
+    static uint8_t toBucket(uint32_t gapMicros) {
+      uint8_t bucket = 0;
+      while (gapMicros > 1 && bucket < kNumBuckets - 1) {
+        gapMicros >>= 1;
+        bucket++;
+      }
+      return bucket;
+    }
+
+  private:
+    // Disable copy-constructor and assignment operator
+    LoopJitter(const LoopJitter&) = delete;
+    LoopJitter& operator=(const LoopJitter&) = delete;
+
+    void record(uint32_t gapMicros) {
+      uint8_t bucket = toBucket(gapMicros);
+      if (mCounts[bucket] < UINT16_MAX) mCounts[bucket]++;
+      if (gapMicros > mMaxGapMicros) mMaxGapMicros = gapMicros;
+
+      if (gapMicros > mOutlierMicros) {
+        Outlier& outlier = mOutliers[mOutlierHead];
+        outlier.gapMicros = gapMicros;
+        outlier.tag = mTag;
+        mOutlierHead = (mOutlierHead + 1) % kNumOutliers;
+        if (mNumOutliers < UINT16_MAX) mNumOutliers++;
+      }
+    }
+
+  private:
+    uint32_t const mOutlierMicros;
+    uint32_t mLastMicros = 0;
+    uint32_t mMaxGapMicros = 0;
+    const char* mTag = nullptr;
+    uint16_t mCounts[kNumBuckets] = {};
+    Outlier mOutliers[kNumOutliers] = {};
+    uint16_t mNumOutliers = 0;
+    uint8_t mOutlierHead = 0;
+    bool mStarted = false;
+};
+
+} // cli
+} // ace_utils
+
+#endif
@@ -0,0 +1,182 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <Arduino.h> // Print, PROGMEM, memcpy_P()
+#include "NumberFormat.h"
+
+namespace ace_utils {
+namespace cli {
+
+// "00" to "99", to convert 2 digits with a single division.
+static const char DIGIT_PAIRS[] PROGMEM =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+static const char HEX_DIGITS[] PROGMEM = "0123456789ABCDEF";
+
+/** Write the 2 digits of 'value' (0-99) at 'p'. */
+static void writePair(char* p, uint8_t value) {
+  memcpy_P(p, DIGIT_PAIRS + 2 * value, 2);
+}
+
+static char hexDigit(uint8_t nibble) {
+  return pgm_read_byte(HEX_DIGITS + nibble);
+}
+
+char* NumberFormat::formatUint(char* end, uint32_t value) {
+  char* p = end;
+
+  // Use 32-bit divisions only for the chunks of 4 digits above the lowest.
+  while (value >= 10000) {
+    uint16_t chunk = value % 10000;
+    value /= 10000;
+    p -= 4;
+    writePair(p, chunk / 100);
+    writePair(p + 2, chunk % 100);
+  }
+
+  uint16_t v = value;
+  while (v >= 100) {
+    p -= 2;
+    writePair(p, v % 100);
+    v /= 100;
+  }
+  if (v >= 10) {
+    p -= 2;
+    writePair(p, v);
+  } else {
+    *--p = '0' + v;
+  }
+  return p;
+}
+
+char* NumberFormat::formatDigits(char* end, uint32_t value, uint8_t width) {
+  char* start = end - width;
+  char* p = formatUint(end, value);
+  while (p > start) *--p = '0';
+  return p;
+}
+
+size_t NumberFormat::printUint(Print& printer, uint32_t value) {
+  char buf[10];
+  char* end = buf + sizeof(buf);
+  char* p = formatUint(end, value);
+  return printer.write((const uint8_t*) p, end - p);
+}
+
+size_t NumberFormat::printInt(Print& printer, int32_t value) {
+  char buf[11];
+  char* end = buf + sizeof(buf);
+  uint32_t magnitude = (value < 0) ? -(uint32_t) value : value;
+  char* p = formatUint(end, magnitude);
+  if (value < 0) *--p = '-';
+  return printer.write((const uint8_t*) p, end - p);
+}
+
+size_t NumberFormat::printHex(Print& printer, uint32_t value, uint8_t width) {
+  char buf[8];
+  if (width > sizeof(buf)) width = sizeof(buf);
+  for (uint8_t i = width; i > 0; i--) {
+    buf[i - 1] = hexDigit(value & 0xF);
+    value >>= 4;
+  }
+  return printer.write((const uint8_t*) buf, width);
+}
+
+size_t NumberFormat::printFixed(
+    Print& printer, int32_t value, uint8_t decimals) {
+  if (decimals == 0) return printInt(printer, value);
+  if (decimals > 9) decimals = 9;
+
+  uint32_t scale = 1;
+  for (uint8_t i = 0; i < decimals; i++) scale *= 10;
+  uint32_t magnitude = (value < 0) ? -(uint32_t) value : value;
+
+  char buf[12]; // "-", 10 digits, "."
+  char* end = buf + sizeof(buf);
+  char* p = formatDigits(end, magnitude % scale, decimals);
+  *--p = '.';
+  p = formatUint(p, magnitude / scale);
+  if (value < 0) *--p = '-';
+  return printer.write((const uint8_t*) p, end - p);
+}
+
+size_t NumberFormat::printHexDumpRow(Print& printer, uint16_t address,
+    const uint8_t* data, uint8_t len) {
+  if (len > kHexDumpRowSize) len = kHexDumpRowSize;
+
+  // "AAAA: " + "XX " * 16 + " " + 16 ASCII + "\r\n"
+  char buf[6 + 3 * kHexDumpRowSize + 1 + kHexDumpRowSize + 2];
+  char* p = buf;
+  for (uint8_t shift = 16; shift > 0; ) {
+    shift -= 4;
+    *p++ = hexDigit((address >> shift) & 0xF);
+  }
+  *p++ = ':';
+  *p++ = ' ';
+
+  for (uint8_t i = 0; i < kHexDumpRowSize; i++) {
+    if (i < len) {
+      *p++ = hexDigit(data[i] >> 4);
+      *p++ = hexDigit(data[i] & 0xF);
+    } else {
+      *p++ = ' ';
+      *p++ = ' ';
+    }
+    *p++ = ' ';
+  }
+  *p++ = ' ';
+
+  for (uint8_t i = 0; i < len; i++) {
+    uint8_t c = data[i];
+    *p++ = (c >= ' ' && c <= '~') ? c : '.';
+  }
+  *p++ = '\r';
+  *p++ = '\n';
+  return printer.write((const uint8_t*) buf, p - buf);
+}
+
+size_t NumberFormat::printHexDump(Print& printer, uint16_t address,
+    const uint8_t* data, uint16_t len) {
+  size_t n = 0;
+  while (len > 0) {
+    uint8_t rowLen = (len > kHexDumpRowSize) ? kHexDumpRowSize : len;
+    n += printHexDumpRow(printer, address, data, rowLen);
+    address += rowLen;
+    data += rowLen;
+    len -= rowLen;
+  }
+  return n;
+}
+
+} // cli
+} // ace_utils
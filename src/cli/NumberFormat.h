@@ -0,0 +1,108 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_NUMBER_FORMAT_H
+#define ACE_UTILS_CLI_NUMBER_FORMAT_H
+
+#include <stdint.h>
+#include <stddef.h> // size_t
+
+class Print;
+
+namespace ace_utils {
+namespace cli {
+
+/**
+ * Fast replacements of Print::print() for the numbers printed by the command
+ * handlers, without `String` temporaries or `sprintf()`. Each function formats
+ * the value into a small buffer on the stack, then sends it to the Print
+ * using a single write() call.
+ *
+ * Print::print(long) divides the 32-bit value by 10 once per digit, which is
+ * slow on 8-bit processors. printUint() divides by 10000 in 32 bits, then
+ * works on 16-bit chunks, and converts 2 digits at a time using a table of
+ * digit pairs in PROGMEM. The hex functions use only shifts and masks.
+ */
+class NumberFormat {
+  public:
+    /** Maximum number of bytes in a row of printHexDump(). */
+    static uint8_t const kHexDumpRowSize = 16;
+
+    /** Print 'value' in decimal. Return the number of bytes written. */
+    static size_t printUint(Print& printer, uint32_t value);
+
+    /** Print 'value' in decimal, with a '-' if negative. */
+    static size_t printInt(Print& printer, int32_t value);
+
+    /**
+     * Print the lowest 'width' nibbles of 'value' in uppercase hex, padded
+     * with leading zeros, e.g. printHex(printer, 0x1F, 4) prints "001F".
+     * The width is at most 8.
+     */
+    static size_t printHex(Print& printer, uint32_t value, uint8_t width);
+
+    /**
+     * Print 'value', which is scaled by 10^decimals, as a fixed-point
+     * number, e.g. printFixed(printer, -1234, 2) prints "-12.34", and
+     * printFixed(printer, 5, 3) prints "0.005". The number of decimals is at
+     * most 9.
+     */
+    static size_t printFixed(Print& printer, int32_t value, uint8_t decimals);
+
+    /**
+     * Print one row of a hex dump, as the 4-digit 'address', followed by up
+     * to kHexDumpRowSize bytes of 'data' in hex, and the same bytes as ASCII
+     * (with '.' for the non-printable ones), followed by a newline. A short
+     * row is padded so that the ASCII columns line up.
+     *
+     * @code
+     * 0010: 48 65 6C 6C 6F 00 FF 20 ...  Hello.. ...
+     * @endcode
+     */
+    static size_t printHexDumpRow(Print& printer, uint16_t address,
+        const uint8_t* data, uint8_t len);
+
+    /**
+     * Print 'len' bytes of 'data' as rows of printHexDumpRow(), starting at
+     * 'address'. To dump memory which is not directly addressable (e.g.
+     * EEPROM), copy each row into a RAM buffer and call printHexDumpRow().
+     */
+    static size_t printHexDump(Print& printer, uint16_t address,
+        const uint8_t* data, uint16_t len);
+
+  private:
+    /**
+     * Write the decimal digits of 'value' to the end of the buffer which ends
+     * at 'end', and return the pointer to the first digit.
+     */
+    static char* formatUint(char* end, uint32_t value);
+
+    /** Write exactly 'width' decimal digits of 'value' before 'end'. */
+    static char* formatDigits(char* end, uint32_t value, uint8_t width);
+};
+
+} // cli
+} // ace_utils
+
+#endif
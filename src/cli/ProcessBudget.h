@@ -0,0 +1,114 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_PROCESS_BUDGET_H
+#define ACE_UTILS_CLI_PROCESS_BUDGET_H
+
+#include <stdint.h>
+#include <Arduino.h> // micros()
+
+namespace ace_utils {
+namespace cli {
+
+/**
+ * Limits the amount of work done by a single call to DirectProcessor::process()
+ * or a single iteration of StreamProcessorCoroutine, so that a long script
+ * pasted into the terminal does not hold the loop() for hundreds of
+ * milliseconds. The limits are the number of bytes read from the Stream, the
+ * number of commands run, and the micros() elapsed since the start of the
+ * call. A limit of 0 means unlimited. The default is unlimited.
+ *
+ * When a limit is reached while there is more input waiting, the processor
+ * stops (or yields), records a hit, and continues from the same place on the
+ * next call.
+ */
+class ProcessBudget {
+  public:
+    /**
+     * Set the limits of the budget.
+     *
+     * @param maxBytes maximum number of bytes read from the Stream per call
+     * @param maxCommands maximum number of commands run per call
+     * @param maxMicros maximum micros() spent per call. This is checked
+     *        between commands and between the chunks of a payload, so a
+     *        single slow command can exceed it.
+     */
+    void setLimits(uint16_t maxBytes, uint8_t maxCommands, uint32_t maxMicros) {
+      mMaxBytes = maxBytes;
+      mMaxCommands = maxCommands;
+      mMaxMicros = maxMicros;
+    }
+
+    /** Start a new call. */
+    void start() {
+      mBytes = 0;
+      mCommands = 0;
+      if (mMaxMicros) mStartMicros = micros();
+    }
+
+    /**
+     * Return the number of bytes that may still be read in this call,
+     * clamped to 255.
+     */
+    uint8_t getByteAllowance() const {
+      if (mMaxBytes == 0) return 255;
+      uint16_t remaining = (mBytes < mMaxBytes) ? mMaxBytes - mBytes : 0;
+      return (remaining > 255) ? 255 : remaining;
+    }
+
+    /** Record the bytes read from the Stream. */
+    void addBytes(uint8_t n) { mBytes += n; }
+
+    /** Record a command that was run. */
+    void addCommand() { mCommands++; }
+
+    /** Return true if any of the limits was reached in this call. */
+    bool isExhausted() const {
+      return (mMaxBytes && mBytes >= mMaxBytes)
+          || (mMaxCommands && mCommands >= mMaxCommands)
+          || (mMaxMicros
+              && (uint32_t) micros() - mStartMicros >= mMaxMicros);
+    }
+
+    /** Record that the processor stopped early because of the budget. */
+    void recordHit() { mNumHits++; }
+
+    /** Return the number of calls which stopped early. */
+    uint16_t getNumHits() const { return mNumHits; }
+
+  private:
+    uint16_t mMaxBytes = 0;
+    uint8_t mMaxCommands = 0;
+    uint32_t mMaxMicros = 0;
+
+    uint16_t mBytes = 0;
+    uint8_t mCommands = 0;
+    uint32_t mStartMicros = 0;
+    uint16_t mNumHits = 0;
+};
+
+} // cli
+} // ace_utils
+
+#endif
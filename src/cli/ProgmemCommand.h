@@ -0,0 +1,100 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_PROGMEM_COMMAND_H
+#define ACE_UTILS_CLI_PROGMEM_COMMAND_H
+
+#include <Arduino.h> // PROGMEM, pgm_read_ptr()
+
+class Print;
+
+namespace ace_utils {
+namespace cli {
+
+/** Signature of the function which implements a ProgmemCommand. */
+typedef void (*CommandFunction)(
+    Print& printer, int argc, const char* const* argv);
+
+/**
+ * An entry of a command table which is stored entirely in flash memory, as an
+ * alternative to an array of CommandHandler pointers. A CommandHandler object
+ * consumes RAM for its vtable pointer and its 2 FCString members, in addition
+ * to the pointer in the COMMANDS array. A ProgmemCommand consumes no RAM at
+ * all on AVR, because the table, the names and the help strings are all
+ * placed in PROGMEM, and read through pgm_read_ptr() by the
+ * CommandDispatcher.
+ *
+ * Example usage:
+ *
+ * @code
+ * static void listCommand(Print& printer, int argc, const char* const* argv) {
+ *   ...
+ * }
+ *
+ * static const char LIST_NAME[] PROGMEM = "list";
+ * static const char LIST_HELP[] PROGMEM = "[files ...]";
+ *
+ * static const ProgmemCommand COMMANDS[] PROGMEM = {
+ *   {LIST_NAME, LIST_HELP, listCommand},
+ *   ...
+ * };
+ * static const uint8_t NUM_COMMANDS =
+ *     sizeof(COMMANDS) / sizeof(ProgmemCommand);
+ * @endcode
+ *
+ * The name and the help string must be PROGMEM strings. The help string can
+ * be nullptr. The ProgmemCommand does not support long-running commands (see
+ * CommandHandler::poll()) or the per-command statistics.
+ */
+struct ProgmemCommand {
+  /** Name of the command, in PROGMEM. */
+  const char* name;
+
+  /** Help string of the command, in PROGMEM, or nullptr. */
+  const char* helpString;
+
+  /** Function which runs the command. */
+  CommandFunction run;
+
+  /** Read the name of the given entry, which is in PROGMEM. */
+  static const __FlashStringHelper* readName(const ProgmemCommand* entry) {
+    return (const __FlashStringHelper*) pgm_read_ptr(&entry->name);
+  }
+
+  /** Read the help string of the given entry, which is in PROGMEM. */
+  static const __FlashStringHelper* readHelpString(
+      const ProgmemCommand* entry) {
+    return (const __FlashStringHelper*) pgm_read_ptr(&entry->helpString);
+  }
+
+  /** Read the function of the given entry, which is in PROGMEM. */
+  static CommandFunction readRun(const ProgmemCommand* entry) {
+    return (CommandFunction) pgm_read_ptr(&entry->run);
+  }
+};
+
+} // cli
+} // ace_utils
+
+#endif
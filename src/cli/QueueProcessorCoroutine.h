@@ -0,0 +1,97 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_QUEUE_PROCESSOR_COROUTINE_H
+#define ACE_UTILS_CLI_QUEUE_PROCESSOR_COROUTINE_H
+
+#include <AceRoutine.h> // Coroutine
+#include "InputLine.h"
+
+class Print;
+
+namespace ace_utils {
+namespace cli {
+
+class CommandDispatcher;
+class CommandHandler;
+class LineQueue;
+
+/**
+ * A coroutine that reads lines from a LineQueue (e.g. written by
+ * QueueReaderCoroutine), then sends the command to the CommandDispatcher for
+ * processing. The slot of each line is released only after its command
+ * finishes, so the line stays valid while the command runs. A long-running
+ * command (see CommandHandler::poll()) is awaited before its slot is released.
+ */
+class QueueProcessorCoroutine: public ace_routine::Coroutine {
+  public:
+    /**
+     * Constructor.
+     *
+     * @param queue A LineQueue from the QueueReaderCoroutine to this
+     *        coroutine.
+     * @param commandDispatcher instance of CommandDispatcher
+     * @param printer The output object, normally the global Serial object.
+     * @param prompt Print this prompt just before accepting character inputs.
+     *        If null, don't print the prompt.
+     */
+    QueueProcessorCoroutine(
+        LineQueue& queue,
+        const CommandDispatcher& commandDispatcher,
+        Print& printer,
+        const char* prompt
+    ) :
+        mQueue(queue),
+        mCommandDispatcher(commandDispatcher),
+        mPrinter(printer),
+        mPrompt(prompt)
+    {}
+
+    int runCoroutine() override;
+
+    /** Return the CommandDispatcher. VisibleForTesting. */
+    const CommandDispatcher& getDispatcher() const {
+      return mCommandDispatcher;
+    }
+
+  private:
+    // Disable copy-constructor and assignment operator
+    QueueProcessorCoroutine(const QueueProcessorCoroutine&) = delete;
+    QueueProcessorCoroutine& operator=(const QueueProcessorCoroutine&) =
+        delete;
+
+    void printLineError(const char* line, uint8_t statusCode) const;
+
+  private:
+    LineQueue& mQueue;
+    const CommandDispatcher& mCommandDispatcher;
+    Print& mPrinter;
+    const char* const mPrompt;
+    const CommandHandler* mActiveCommand = nullptr;
+};
+
+} // cli
+} // ace_utils
+
+#endif
@@ -0,0 +1,147 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_QUEUE_PROCESSOR_MANAGER_H
+#define ACE_UTILS_CLI_QUEUE_PROCESSOR_MANAGER_H
+
+#include <AceRoutine.h> // Coroutine
+#include "CommandDispatcher.h"
+#include "LineQueue.h"
+#include "QueueReaderCoroutine.h"
+#include "QueueProcessorCoroutine.h"
+
+namespace ace_utils {
+namespace cli {
+
+/**
+ * A variant of ChannelProcessorManager which connects the reader and the
+ * processor coroutines through a LineQueue of NUM_SLOTS line buffers instead
+ * of a single-slot Channel. The QueueReaderCoroutine keeps draining the
+ * Stream into free slots while a slow command runs in the
+ * QueueProcessorCoroutine, so the serial receive buffer does not overrun as
+ * long as no more than NUM_SLOTS lines arrive during a single command. Lines
+ * which arrive when all slots are full are discarded and counted in
+ * getLineQueue().getNumDropped().
+ *
+ * Example usage:
+ *
+ * @code
+ * const uint8_t BUF_SIZE = 64;
+ * const uint8_t ARGV_SIZE = 5;
+ * const uint8_t NUM_SLOTS = 4;
+ * const char PROMPT[] = "$ ";
+ *
+ * QueueProcessorManager<BUF_SIZE, ARGV_SIZE, NUM_SLOTS> commandManager(
+ *     Serial, COMMANDS, NUM_COMMANDS, Serial, PROMPT);
+ *
+ * void setup() {
+ *   ...
+ *   CoroutineScheduler::setup();
+ * }
+ * @endcode
+ *
+ * @param BUF_SIZE Size of each input line buffer.
+ * @param ARGV_SIZE Size of the command line argv token list.
+ * @param NUM_SLOTS Number of line buffers in the queue.
+ */
+template<uint8_t BUF_SIZE, uint8_t ARGV_SIZE, uint8_t NUM_SLOTS>
+class QueueProcessorManager {
+  public:
+
+    /**
+     * Constructor.
+     *
+     * @param stream The serial port used to read commands and send output,
+     *        will normally be 'Serial', but can be set to something else.
+     * @param commands Array of (CommandHandler*).
+     * @param numCommands Number of commands in 'commands'.
+     * @param printer output stream, often the same as `stream` but not always
+     * @param prompt Print this prompt just before accepting character inputs.
+     *        If null, don't print the prompt.
+     */
+    QueueProcessorManager(
+        Stream& stream,
+        const CommandHandler* const* commands,
+        uint8_t numCommands,
+        Print& printer,
+        const char* prompt = nullptr
+    ) :
+        mLineQueue(&mLineBuffers[0][0], BUF_SIZE, NUM_SLOTS, mLineStatuses),
+        mQueueReader(mLineQueue, stream),
+        mCommandDispatcher(commands, numCommands, mArgv, ARGV_SIZE,
+            nullptr /*sortedIndex*/, mTokens, BUF_SIZE),
+        mQueueProcessor(mLineQueue, mCommandDispatcher, printer, prompt)
+    {}
+
+    /** Return the QueueReaderCoroutine. */
+    QueueReaderCoroutine& getQueueReader() {
+      return mQueueReader;
+    }
+
+    /** Return the QueueProcessorCoroutine. */
+    QueueProcessorCoroutine& getQueueProcessor() {
+      return mQueueProcessor;
+    }
+
+    /** Return the LineQueue, for its depth and drop counters. */
+    const LineQueue& getLineQueue() const {
+      return mLineQueue;
+    }
+
+    /**
+     * Return the underlying CommandDispatcher, e.g. to create a BoundCommand
+     * or to give it to a WatchManager.
+     */
+    const CommandDispatcher& getCommandDispatcher() const {
+      return mCommandDispatcher;
+    }
+
+    /**
+     * Give the ScratchArena to the commands, see
+     * CommandDispatcher::setScratchArena().
+     */
+    void setScratchArena(ScratchArena* arena) {
+      mCommandDispatcher.setScratchArena(arena);
+    }
+
+  private:
+    // Disable copy-constructor and assignment operator
+    QueueProcessorManager(const QueueProcessorManager&) = delete;
+    QueueProcessorManager& operator=(const QueueProcessorManager&) = delete;
+
+  private:
+    LineQueue mLineQueue;
+    QueueReaderCoroutine mQueueReader;
+    CommandDispatcher mCommandDispatcher;
+    QueueProcessorCoroutine mQueueProcessor;
+    char mLineBuffers[NUM_SLOTS][BUF_SIZE];
+    uint8_t mLineStatuses[NUM_SLOTS];
+    const char* mArgv[ARGV_SIZE];
+    char mTokens[BUF_SIZE];
+};
+
+} // cli
+} // ace_utils
+
+#endif
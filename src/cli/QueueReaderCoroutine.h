@@ -0,0 +1,152 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_QUEUE_READER_COROUTINE_H
+#define ACE_UTILS_CLI_QUEUE_READER_COROUTINE_H
+
+#include <Arduino.h> // Stream
+#include <AceRoutine.h>
+#include "InputLine.h"
+#include "LineQueue.h"
+
+namespace ace_utils {
+namespace cli {
+
+/**
+ * An AceRoutine coroutine that reads lines (terminated by '\\n' or '\\r') from
+ * the Stream device, and pushes them into a LineQueue. Unlike
+ * StreamReaderCoroutine, it never waits for the consumer: while the
+ * QueueProcessorCoroutine is busy, the following lines are assembled in the
+ * other slots of the queue. If the queue is full when a new line starts, the
+ * line is read and discarded, and counted by LineQueue::getNumDropped(), so
+ * that the UART receive buffer does not overrun.
+ *
+ * A line which overflows its slot is pushed with InputLine::kStatusOverflow,
+ * and the rest of the line is discarded without taking another slot, like
+ * the LineReader does. Empty lines do not take a slot, and the '\n' of a
+ * "\r\n" pair is skipped, so CRLF input uses one slot per line. The
+ * coroutine yields after each line which is pushed, so that a fast input
+ * Stream does not hold the CoroutineScheduler.
+ */
+class QueueReaderCoroutine : public ace_routine::Coroutine {
+  public:
+    /**
+     * Constructor.
+     *
+     * @param queue The output LineQueue.
+     * @param stream The input stream, usually the global Serial object.
+     */
+    QueueReaderCoroutine(LineQueue& queue, Stream& stream):
+        mQueue(queue),
+        mStream(stream)
+    {}
+
+    /**
+     * Main body of the coroutine that reads characters from the input stream
+     * and pushes complete lines into the LineQueue.
+     */
+    int runCoroutine() override {
+      COROUTINE_LOOP() {
+        COROUTINE_AWAIT(mStream.available() > 0);
+
+        while (mStream.available() > 0) {
+          if (readChar(mStream.read())) COROUTINE_YIELD();
+        }
+      }
+    }
+
+  private:
+    // Disable copy-constructor and assignment operator
+    QueueReaderCoroutine(const QueueReaderCoroutine&) = delete;
+    QueueReaderCoroutine& operator=(const QueueReaderCoroutine&) = delete;
+
+    /** Handle the character 'c'. Return true if a line was pushed. */
+    bool readChar(char c) {
+      bool isEol = (c == '\n' || c == '\r');
+
+      // The '\n' of a "\r\n" pair does not end another line.
+      bool isCrLf = (c == '\n' && mLastCr);
+      mLastCr = (c == '\r');
+      if (isCrLf) return false;
+
+      if (mFlushLine) {
+        // Discard the rest of an overflowed line.
+        if (isEol) mFlushLine = false;
+        return false;
+      }
+
+      if (mDropping) {
+        if (isEol) {
+          mDropping = false;
+          mQueue.recordDrop();
+        }
+        return false;
+      }
+
+      if (mSlot == nullptr) {
+        if (isEol) return false; // empty line
+        mSlot = mQueue.acquireSlot();
+        mIndex = 0;
+        if (mSlot == nullptr) {
+          mDropping = true;
+          return false;
+        }
+      }
+
+      mSlot[mIndex] = c;
+      mIndex++;
+      if (isEol) {
+        pushSlot(InputLine::kStatusOk);
+        return true;
+      }
+      if (mIndex >= mQueue.getBufferSize() - 1) {
+        pushSlot(InputLine::kStatusOverflow);
+        mFlushLine = true;
+        return true;
+      }
+      return false;
+    }
+
+    /** Terminate the current slot and commit it to the queue. */
+    void pushSlot(uint8_t status) {
+      mSlot[mIndex] = '\0';
+      mQueue.push(status);
+      mSlot = nullptr;
+    }
+
+  private:
+    LineQueue& mQueue;
+    Stream& mStream;
+
+    char* mSlot = nullptr;
+    uint8_t mIndex = 0;
+    bool mFlushLine = false;
+    bool mDropping = false;
+    bool mLastCr = false;
+};
+
+} // cli
+} // ace_utils
+
+#endif
@@ -0,0 +1,233 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_RING_BUFFER_STREAM_H
+#define ACE_UTILS_CLI_RING_BUFFER_STREAM_H
+
+#include <stdint.h>
+#include <Arduino.h> // Stream
+#if defined(ARDUINO_ARCH_AVR)
+  #include <util/atomic.h> // ATOMIC_BLOCK
+#endif
+
+namespace ace_utils {
+namespace cli {
+
+/**
+ * A single-producer, single-consumer ring buffer which implements Stream, so
+ * that it can be read by any of the processors (DirectProcessor,
+ * StreamProcessorCoroutine, etc). The producer is usually an interrupt
+ * handler (e.g. the UART receive interrupt, or the callback of a network
+ * stack) which calls put() for each byte received, so that the input is
+ * buffered in a ring larger than the RX buffer of the core (often 64 bytes)
+ * while the CLI is busy running a command. The producer can also be another
+ * thread on platforms which have threads.
+ *
+ * The producer owns the head index and the consumer owns the tail index, so
+ * no lock is needed: each side reads the index of the other side with an
+ * acquire load, and publishes its own index with a release store, using the
+ * GCC __atomic builtins. The 8-bit AVR processors have no atomic 16-bit or
+ * 32-bit access, so on AVR these accesses are done with interrupts disabled
+ * (ATOMIC_BLOCK) instead, and the producer must be an interrupt handler. The
+ * indexes run freely over the full uint16_t range, and are masked into the
+ * buffer, so the capacity must be a power of 2, no larger than 32768. The
+ * capacity given to the constructor is not checked; FixedRingBufferStream
+ * checks it at compile time.
+ *
+ * If the ring is full, put() drops the byte and increments the overrun
+ * counter. The maximum number of bytes ever held in the ring is available
+ * through getHighWater(), to help choose the capacity.
+ *
+ * The Stream is input-only: write() discards its output.
+ */
+class RingBufferStream: public Stream {
+  public:
+    /**
+     * Constructor.
+     *
+     * @param buffer storage for the ring buffer
+     * @param capacity size of the buffer, must be a power of 2, no larger than
+     *        32768
+     */
+    RingBufferStream(uint8_t* buffer, uint16_t capacity):
+        mBuf(buffer),
+        mMask(capacity - 1)
+    {}
+
+    //-----------------------------------------------------------------------
+    // Producer. Must be called from a single interrupt handler or thread.
+    //-----------------------------------------------------------------------
+
+    /**
+     * Append the byte 'c' to the ring. Return false if the ring is full, in
+     * which case the byte is dropped and counted in getNumOverruns().
+     */
+    bool put(uint8_t c) {
+      uint16_t head = mHead;
+      uint16_t used = head - loadAcquire(mTail);
+      if (used > mMask) {
+        addOverruns(1);
+        return false;
+      }
+      mBuf[head & mMask] = c;
+      storeRelease(mHead, (uint16_t) (head + 1));
+      updateHighWater(used + 1);
+      return true;
+    }
+
+    /**
+     * Append 'len' bytes to the ring. Return the number of bytes appended.
+     * The bytes which do not fit are dropped, and counted in
+     * getNumOverruns().
+     */
+    uint16_t put(const uint8_t* data, uint16_t len) {
+      uint16_t head = mHead;
+      uint16_t used = head - loadAcquire(mTail);
+      uint16_t room = mMask + 1 - used;
+      uint16_t n = (len > room) ? room : len;
+      for (uint16_t i = 0; i < n; i++) {
+        mBuf[(head + i) & mMask] = data[i];
+      }
+      storeRelease(mHead, (uint16_t) (head + n));
+      updateHighWater(used + n);
+      if (n < len) addOverruns(len - n);
+      return n;
+    }
+
+    /**
+     * Return the free space in the ring, for a producer which prefers to
+     * wait instead of dropping bytes.
+     */
+    int availableForWrite() override {
+      uint16_t tail = loadAcquire(mTail);
+      return mMask + 1 - (uint16_t) (mHead - tail);
+    }
+
+    //-----------------------------------------------------------------------
+    // Consumer. The Stream interface, called by the processor.
+    //-----------------------------------------------------------------------
+
+    int available() override {
+      uint16_t head = loadAcquire(mHead);
+      return (uint16_t) (head - mTail);
+    }
+
+    int read() override {
+      uint16_t tail = mTail;
+      if (loadAcquire(mHead) == tail) return -1;
+      uint8_t c = mBuf[tail & mMask];
+      storeRelease(mTail, (uint16_t) (tail + 1));
+      return c;
+    }
+
+    int peek() override {
+      uint16_t tail = mTail;
+      if (loadAcquire(mHead) == tail) return -1;
+      return mBuf[tail & mMask];
+    }
+
+    size_t write(uint8_t /*c*/) override { return 0; }
+
+    using Print::write;
+
+    //-----------------------------------------------------------------------
+    // Statistics. Updated by the producer.
+    //-----------------------------------------------------------------------
+
+    /** Return the maximum number of bytes held in the ring. */
+    uint16_t getHighWater() const { return loadAcquire(mHighWater); }
+
+    /** Return the number of bytes dropped because the ring was full. */
+    uint32_t getNumOverruns() const { return loadAcquire(mNumOverruns); }
+
+  private:
+    // Disable copy-constructor and assignment operator
+    RingBufferStream(const RingBufferStream&) = delete;
+    RingBufferStream& operator=(const RingBufferStream&) = delete;
+
+    /** Load a value which is written by the other side. */
+    template <typename T>
+    static T loadAcquire(const T& value) {
+    #if defined(ARDUINO_ARCH_AVR)
+      T result;
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { result = value; }
+      return result;
+    #else
+      return __atomic_load_n(&value, __ATOMIC_ACQUIRE);
+    #endif
+    }
+
+    /** Store a value which is read by the other side. */
+    template <typename T>
+    static void storeRelease(T& dest, T value) {
+    #if defined(ARDUINO_ARCH_AVR)
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { dest = value; }
+    #else
+      __atomic_store_n(&dest, value, __ATOMIC_RELEASE);
+    #endif
+    }
+
+    // The statistics are written by the producer only, but are read by the
+    // consumer, so they are stored atomically.
+
+    void updateHighWater(uint16_t used) {
+      if (used > mHighWater) storeRelease(mHighWater, used);
+    }
+
+    void addOverruns(uint16_t n) {
+      storeRelease(mNumOverruns, mNumOverruns + n);
+    }
+
+  private:
+    uint8_t* const mBuf;
+    uint16_t const mMask;
+
+    uint16_t mHead = 0; // written by the producer only
+    uint16_t mTail = 0; // written by the consumer only
+    uint16_t mHighWater = 0;
+    uint32_t mNumOverruns = 0;
+};
+
+/**
+ * A RingBufferStream which owns a buffer of CAPACITY bytes, and checks at
+ * compile time that the capacity is a power of 2.
+ *
+ * @param CAPACITY size of the ring, a power of 2, no larger than 32768
+ */
+template <uint16_t CAPACITY>
+class FixedRingBufferStream: public RingBufferStream {
+  public:
+    static_assert(CAPACITY != 0 && (CAPACITY & (CAPACITY - 1)) == 0
+        && CAPACITY <= 32768, "CAPACITY must be a power of 2 <= 32768");
+
+    FixedRingBufferStream(): RingBufferStream(mBuffer, CAPACITY) {}
+
+  private:
+    uint8_t mBuffer[CAPACITY];
+};
+
+} // cli
+} // ace_utils
+
+#endif
@@ -0,0 +1,71 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <Arduino.h> // Print, F()
+#include "SchemaCommandHandler.h"
+
+namespace ace_utils {
+namespace cli {
+
+void SchemaCommandHandler::run(
+    Print& printer, int argc, const char* const* argv) const {
+  ArgValue values[kMaxArgs];
+  int8_t numArgs = ArgSchema::parse(
+      printer, mSchema, mNumSpecs, argc - 1, argv + 1, values, kMaxArgs);
+  if (numArgs < 0) {
+    printUsageError(printer);
+    return;
+  }
+  runArgs(printer, values, numArgs);
+}
+
+bool SchemaCommandHandler::runTyped(Print& printer, uint8_t numArgs,
+    const ArgValue* args, const uint8_t* types) const {
+  ArgValue values[kMaxArgs];
+  int8_t numValues = ArgSchema::parseTyped(
+      printer, mSchema, mNumSpecs, numArgs, args, types, values, kMaxArgs);
+  if (numValues < 0) {
+    printUsageError(printer);
+  } else {
+    runArgs(printer, values, numValues);
+  }
+  return true;
+}
+
+void SchemaCommandHandler::printUsageError(Print& printer) const {
+  printer.print(F("Usage: "));
+  printUsage(printer);
+  printer.println();
+}
+
+void SchemaCommandHandler::printUsage(Print& printer) const {
+  getName().printTo(printer);
+  if (mNumSpecs > 0) {
+    printer.print(' ');
+    ArgSchema::printUsage(printer, mSchema, mNumSpecs);
+  }
+}
+
+} // cli
+} // ace_utils
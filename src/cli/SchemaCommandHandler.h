@@ -0,0 +1,128 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_SCHEMA_COMMAND_HANDLER_H
+#define ACE_UTILS_CLI_SCHEMA_COMMAND_HANDLER_H
+
+#include "ArgSchema.h"
+#include "CommandHandler.h"
+
+namespace ace_utils {
+namespace cli {
+
+/**
+ * A CommandHandler whose arguments are declared by an array of ArgSpec in
+ * PROGMEM. The run() method validates and converts the argv tokens using
+ * ArgSchema::parse() before calling runArgs(), so that the subclass receives
+ * the typed values and does not need to parse or validate them. If the
+ * arguments are invalid, runArgs() is not called, and an error message is
+ * printed followed by the usage line. The help string printed by the `help`
+ * command and the usage line are both generated from the same schema.
+ *
+ * The typed arguments of a binary request of the FrameProcessor are passed
+ * to runArgs() through runTyped() and ArgSchema::parseTyped(), so that an
+ * integer argument is not formatted into text and parsed again.
+ *
+ * Example usage:
+ *
+ * @code
+ * class DelayCommand: public SchemaCommandHandler {
+ *   public:
+ *     DelayCommand():
+ *         SchemaCommandHandler(F("delay"), DELAY_SCHEMA, 2) {}
+ *
+ *   protected:
+ *     void runArgs(Print& printer, const ArgValue* args, uint8_t numArgs)
+ *         const override {
+ *       if (numArgs == 0) {
+ *         ...
+ *       } else if (args[0].e == 0) {
+ *         ledOnDelay = args[1].i;
+ *       } else {
+ *         ledOffDelay = args[1].i;
+ *       }
+ *     }
+ * };
+ * @endcode
+ */
+class SchemaCommandHandler: public CommandHandler {
+  public:
+    /** Maximum number of argument values passed into runArgs(). */
+    static uint8_t const kMaxArgs = 8;
+
+    /** Parse the arguments, then call runArgs() if they are valid. */
+    void run(Print& printer, int argc, const char* const* argv)
+        const final;
+
+    /** Validate the typed arguments, then call runArgs() if they are valid. */
+    bool runTyped(Print& printer, uint8_t numArgs, const ArgValue* args,
+        const uint8_t* types) const final;
+
+    /** Print the name of the command and the usage of its arguments. */
+    void printUsage(Print& printer) const override;
+
+  protected:
+    /**
+     * Constructor.
+     *
+     * @param name name of the command
+     * @param schema array of ArgSpec in PROGMEM
+     * @param numSpecs number of elements in 'schema'
+     */
+    SchemaCommandHandler(
+        const __FlashStringHelper* name,
+        const ArgSpec* schema,
+        uint8_t numSpecs
+    ):
+        CommandHandler(name, nullptr),
+        mSchema(schema),
+        mNumSpecs(numSpecs)
+    {}
+
+    /**
+     * Run the command with the arguments which were validated and converted
+     * according to the schema.
+     *
+     * @param printer The output printer, normally Serial.
+     * @param args The values of the arguments, not including the command
+     *        name. A variadic argument contributes one value per token.
+     * @param numArgs Number of values in 'args'. This is smaller than the
+     *        number of arguments in the schema if optional groups are absent.
+     */
+    virtual void runArgs(Print& printer, const ArgValue* args,
+        uint8_t numArgs) const = 0;
+
+  private:
+    /** Print the usage line after the error of invalid arguments. */
+    void printUsageError(Print& printer) const;
+
+  private:
+    const ArgSpec* const mSchema;
+    uint8_t const mNumSpecs;
+};
+
+} // cli
+} // ace_utils
+
+#endif
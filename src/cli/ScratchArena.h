@@ -0,0 +1,135 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_SCRATCH_ARENA_H
+#define ACE_UTILS_CLI_SCRATCH_ARENA_H
+
+#include <stdint.h>
+
+namespace ace_utils {
+namespace cli {
+
+/**
+ * A fixed-size bump allocator for the temporary buffers of a command (e.g.
+ * for formatting, sorting or hex decoding), instead of large arrays on the
+ * stack, or `String` and `malloc()` which fragment the heap. Each allocation
+ * takes the next bytes of the buffer, and all of them are freed together by
+ * reset(), which is called by the CommandDispatcher after every command.
+ * See ArenaCommandHandler.
+ *
+ * An allocation which does not fit returns nullptr, and is counted in
+ * getNumFailures(). The peak usage, getPeakUsed(), shows whether the buffer is
+ * sized correctly.
+ */
+class ScratchArena {
+  public:
+    /**
+     * Constructor.
+     *
+     * @param buffer storage of the arena, can be null if 'size' is 0, in
+     *        which case every allocation fails
+     * @param size size of the buffer
+     */
+    ScratchArena(char* buffer, uint16_t size):
+        mBuf(buffer),
+        mSize(size)
+    {}
+
+    /**
+     * Allocate 'size' bytes, aligned to 'alignment' (a power of 2). Return
+     * nullptr if the arena does not have enough room.
+     */
+    void* allocate(uint16_t size, uint8_t alignment = 1) {
+      // Compute the padding on the integer address, so that the pointer
+      // arithmetic is done only on a real buffer.
+      uint16_t padding = (uint16_t) -((uintptr_t) mBuf + mUsed)
+          & (alignment - 1);
+      if (mBuf == nullptr || size + padding > mSize - mUsed) {
+        mNumFailures++;
+        return nullptr;
+      }
+      char* p = mBuf + mUsed + padding;
+      mUsed += padding + size;
+      if (mUsed > mPeakUsed) mPeakUsed = mUsed;
+      return p;
+    }
+
+    /** Allocate an array of 'count' elements of type T, uninitialized. */
+    template <typename T>
+    T* allocate(uint16_t count) {
+      return (T*) allocate(count * sizeof(T), alignof(T));
+    }
+
+    /**
+     * Return the shared arena of size 0, given to the commands which are run
+     * without an arena. Every allocation from it fails.
+     */
+    static ScratchArena& getEmpty();
+
+    /** Free all the allocations. */
+    void reset() { mUsed = 0; }
+
+    /** Return the size of the arena. */
+    uint16_t getSize() const { return mSize; }
+
+    /** Return the number of bytes currently allocated. */
+    uint16_t getUsed() const { return mUsed; }
+
+    /** Return the maximum number of bytes allocated by a command. */
+    uint16_t getPeakUsed() const { return mPeakUsed; }
+
+    /** Return the number of allocations which did not fit. */
+    uint16_t getNumFailures() const { return mNumFailures; }
+
+  private:
+    // Disable copy-constructor and assignment operator
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+  private:
+    char* const mBuf;
+    uint16_t const mSize;
+    uint16_t mUsed = 0;
+    uint16_t mPeakUsed = 0;
+    uint16_t mNumFailures = 0;
+};
+
+/**
+ * A ScratchArena which owns a buffer of SIZE bytes.
+ *
+ * @param SIZE size of the arena
+ */
+template <uint16_t SIZE>
+class FixedScratchArena: public ScratchArena {
+  public:
+    FixedScratchArena(): ScratchArena(mBuffer, SIZE) {}
+
+  private:
+    char mBuffer[SIZE];
+};
+
+} // cli
+} // ace_utils
+
+#endif
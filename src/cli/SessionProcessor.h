@@ -0,0 +1,163 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_SESSION_PROCESSOR_H
+#define ACE_UTILS_CLI_SESSION_PROCESSOR_H
+
+#include <Arduino.h> // Stream, Print
+#include "CommandDispatcher.h"
+#include "LineReader.h"
+#include "LineBufferPool.h"
+
+namespace ace_utils {
+namespace cli {
+
+/**
+ * The per-Stream state of a SessionProcessorManager. Similar to
+ * DirectProcessor, except that it does not own a line buffer or a
+ * CommandDispatcher. The line buffer is borrowed from a LineBufferPool when
+ * bytes arrive on the Stream, and returned when the session has no partial
+ * line left. If the pool has no free buffer, the bytes are left inside the
+ * Stream until a buffer becomes free.
+ *
+ * While a long-running command (see CommandHandler::poll()) is running, the
+ * session keeps its line buffer and holds its input.
+ */
+class SessionProcessor {
+  public:
+    /**
+     * Constructor.
+     *
+     * @param stream input stream, e.g. Serial or Serial1
+     * @param printer output stream, often the same as `stream` but not always
+     * @param prompt Print this prompt just before accepting character inputs.
+     *        If null, don't print the prompt.
+     */
+    SessionProcessor(
+        Stream& stream,
+        Print& printer,
+        const char* prompt = nullptr
+    ):
+        mStream(stream),
+        mPrinter(printer),
+        mLineReader(nullptr, 0),
+        mPrompt(prompt)
+    {}
+
+    /**
+     * Read the available bytes from the input stream, and execute each
+     * complete line using the shared CommandDispatcher.
+     */
+    void process(const CommandDispatcher& dispatcher, LineBufferPool& pool) {
+      if (mActiveCommand != nullptr) {
+        if (! dispatcher.pollHandler(mPrinter, mActiveCommand)) return;
+        mActiveCommand = nullptr;
+      }
+
+      if (mPrompt && mShouldPrompt) {
+        mPrinter.print(mPrompt);
+        mPrinter.flush();
+        mShouldPrompt = false;
+      }
+
+      if (mLineReader.getBuffer() == nullptr) {
+        if (mStream.available() == 0) return;
+        char* buffer = pool.acquire();
+        if (buffer == nullptr) return;
+        mLineReader.setBuffer(buffer, pool.getBufferSize());
+      }
+
+      // There could be multiple lines waiting, so loop to get all of them.
+      while (true) {
+        uint8_t status = mLineReader.next();
+        if (status == LineReader::kStatusNone) {
+          if (mLineReader.fill(mStream) == 0) break;
+        } else if (status == LineReader::kStatusLine) {
+          mShouldPrompt = true;
+          const CommandHandler* command =
+              dispatcher.runCommand(mPrinter, mLineReader.getLine());
+          if (command != nullptr
+              && ! dispatcher.pollHandler(mPrinter, command)) {
+            // Keep the line buffer, which may hold the following lines.
+            mActiveCommand = command;
+            return;
+          }
+        } else if (status == LineReader::kStatusOverflow) {
+          dispatcher.recordOverflow();
+          mPrinter.println(
+              F("Error: Buffer overflow... flushing until Newline"));
+        } else {
+          // If the buffer had previously overflown, then flush all input
+          // until the \n or \r.
+          mShouldPrompt = true;
+          mPrinter.println(
+              F("Error: Buffer overflow... flushed after Newline"));
+        }
+      }
+
+      if (mLineReader.isIdle()) {
+        pool.release(mLineReader.getBuffer());
+        mLineReader.setBuffer(nullptr, 0);
+      }
+    }
+
+    /** Return true if this session currently holds a line buffer. */
+    bool isActive() const { return mLineReader.getBuffer() != nullptr; }
+
+    /** Return true if a long-running command is waiting to be polled. */
+    bool hasActiveCommand() const { return mActiveCommand != nullptr; }
+
+    /**
+     * Give the line buffer back to the pool, discarding the partial line, and
+     * forget the long-running command, e.g. when the client of the Stream
+     * disconnects, so that the session can be reused for another client.
+     */
+    void reset(LineBufferPool& pool) {
+      if (mLineReader.getBuffer() != nullptr) {
+        pool.release(mLineReader.getBuffer());
+        mLineReader.setBuffer(nullptr, 0);
+      }
+      mActiveCommand = nullptr;
+      mShouldPrompt = true;
+    }
+
+  private:
+    // Disable copy-constructor and assignment operator
+    SessionProcessor(const SessionProcessor&) = delete;
+    SessionProcessor& operator=(const SessionProcessor&) = delete;
+
+  private:
+    Stream& mStream;
+    Print& mPrinter;
+    LineReader mLineReader;
+    const char* const mPrompt;
+    const CommandHandler* mActiveCommand = nullptr;
+
+    bool mShouldPrompt = true;
+};
+
+} // cli
+} // ace_utils
+
+#endif
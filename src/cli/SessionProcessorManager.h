@@ -0,0 +1,145 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_SESSION_PROCESSOR_MANAGER_H
+#define ACE_UTILS_CLI_SESSION_PROCESSOR_MANAGER_H
+
+#include "CommandDispatcher.h"
+#include "LineBufferPool.h"
+#include "SessionProcessor.h"
+
+namespace ace_utils {
+namespace cli {
+
+/**
+ * Serve multiple Streams (e.g. Serial, Serial1 and a debug UART) using a
+ * single CommandDispatcher, a single argv array, and a pool of NUM_BUFFERS
+ * line buffers. Each Stream is represented by a SessionProcessor, which costs
+ * only a few bytes while it is idle. A line buffer is lent to a session only
+ * while it has a partial line, so NUM_BUFFERS can be smaller than the number
+ * of sessions. The argv array can be shared because commands are dispatched
+ * one at a time.
+ *
+ * Example usage:
+ *
+ * @code
+ * static const CommandHandler* const COMMANDS[] = { ... };
+ * static const uint8_t NUM_COMMANDS =
+ *    sizeof(COMMANDS) / sizeof(CommandHandler*);
+ *
+ * SessionProcessor session0(Serial, Serial, "$ ");
+ * SessionProcessor session1(Serial1, Serial1, "$ ");
+ * SessionProcessor session2(Serial2, Serial2);
+ * SessionProcessor* const SESSIONS[] = { &session0, &session1, &session2 };
+ * static const uint8_t NUM_SESSIONS =
+ *    sizeof(SESSIONS) / sizeof(SessionProcessor*);
+ *
+ * const uint8_t BUF_SIZE = 64;
+ * const uint8_t ARGV_SIZE = 5;
+ * const uint8_t NUM_BUFFERS = 2;
+ *
+ * SessionProcessorManager<BUF_SIZE, ARGV_SIZE, NUM_BUFFERS> commandManager(
+ *     SESSIONS, NUM_SESSIONS, COMMANDS, NUM_COMMANDS);
+ *
+ * void loop() {
+ *   commandManager.process();
+ * }
+ * @endcode
+ *
+ * @param BUF_SIZE Size of each input line buffer.
+ * @param ARGV_SIZE Size of the command line argv token list.
+ * @param NUM_BUFFERS Number of line buffers in the pool.
+ */
+template<uint8_t BUF_SIZE, uint8_t ARGV_SIZE, uint8_t NUM_BUFFERS>
+class SessionProcessorManager {
+  public:
+
+    /**
+     * Constructor.
+     *
+     * @param sessions Array of (SessionProcessor*), one for each Stream.
+     * @param numSessions Number of sessions in 'sessions'.
+     * @param commands Array of (CommandHandler*).
+     * @param numCommands Number of commands in 'commands'.
+     */
+    SessionProcessorManager(
+        SessionProcessor* const* sessions,
+        uint8_t numSessions,
+        const CommandHandler* const* commands,
+        uint8_t numCommands
+    ) :
+        mSessions(sessions),
+        mNumSessions(numSessions),
+        mBufferPool(&mBuffers[0][0], BUF_SIZE, NUM_BUFFERS, mFreeList),
+        mCommandDispatcher(commands, numCommands, mArgv, ARGV_SIZE,
+            nullptr /*sortedIndex*/, mTokens, BUF_SIZE)
+    {}
+
+    /** Process the input of each session in turn. */
+    void process() {
+      for (uint8_t i = 0; i < mNumSessions; i++) {
+        mSessions[i]->process(mCommandDispatcher, mBufferPool);
+      }
+    }
+
+    /** Return the pool of line buffers. */
+    LineBufferPool& getBufferPool() {
+      return mBufferPool;
+    }
+
+    /** Return the shared CommandDispatcher. */
+    const CommandDispatcher& getCommandDispatcher() const {
+      return mCommandDispatcher;
+    }
+
+    /**
+     * Give the ScratchArena to the commands, see
+     * CommandDispatcher::setScratchArena().
+     */
+    void setScratchArena(ScratchArena* arena) {
+      mCommandDispatcher.setScratchArena(arena);
+    }
+
+  private:
+    // Disable copy-constructor and assignment operator
+    SessionProcessorManager(const SessionProcessorManager&) = delete;
+    SessionProcessorManager& operator=(const SessionProcessorManager&) =
+        delete;
+
+  private:
+    SessionProcessor* const* const mSessions;
+    uint8_t const mNumSessions;
+    // The free list must be declared before mBufferPool, which fills it.
+    uint8_t mFreeList[NUM_BUFFERS];
+    LineBufferPool mBufferPool;
+    CommandDispatcher mCommandDispatcher;
+    char mBuffers[NUM_BUFFERS][BUF_SIZE];
+    const char* mArgv[ARGV_SIZE];
+    char mTokens[BUF_SIZE];
+};
+
+} // cli
+} // ace_utils
+
+#endif
@@ -0,0 +1,128 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_STATIC_COMMAND_REGISTRY_H
+#define ACE_UTILS_CLI_STATIC_COMMAND_REGISTRY_H
+
+#include <Arduino.h> // Print, strcmp_P()
+
+namespace ace_utils {
+namespace cli {
+
+/**
+ * A compile-time alternative to the array of CommandHandler pointers used by
+ * CommandDispatcher. Each command is a type, not an object, which provides the
+ * following static functions:
+ *
+ * @code
+ * struct EchoCommand {
+ *   static const __FlashStringHelper* name() { return F("echo"); }
+ *   static const __FlashStringHelper* helpString() { return F("args ..."); }
+ *   static void run(Print& printer, int argc, const char* const* argv) {
+ *     ...
+ *   }
+ * };
+ * @endcode
+ *
+ * The helpString() may return nullptr. The registry is a chain of template
+ * instantiations which compares the command name with each name() in turn
+ * (in the order of the template parameters), then calls the matching run()
+ * directly. There is no vtable, no CommandHandler object, and no pointer
+ * array in RAM, and the compiler is free to inline small commands. The names
+ * and help strings stay in flash.
+ *
+ * @param HANDLERS the types of the commands
+ */
+template <typename... HANDLERS>
+class StaticCommandRegistry;
+
+/** The end of the chain. */
+template <>
+class StaticCommandRegistry<> {
+  public:
+    /** Run the command 'cmd'. Return false if not found. */
+    static bool run(const char* /*cmd*/, Print& /*printer*/, int /*argc*/,
+        const char* const* /*argv*/) {
+      return false;
+    }
+
+    /** Print the usage of the command 'cmd'. Return false if not found. */
+    static bool printHelp(Print& /*printer*/, const char* /*cmd*/) {
+      return false;
+    }
+
+    /** Print the help strings of all commands, one per line. */
+    static void printAllHelp(Print& /*printer*/) {}
+};
+
+/** A link of the chain, for the command type HANDLER. */
+template <typename HANDLER, typename... REST>
+class StaticCommandRegistry<HANDLER, REST...> {
+  public:
+    /** Run the command 'cmd'. Return false if not found. */
+    static bool run(const char* cmd, Print& printer, int argc,
+        const char* const* argv) {
+      if (isName(cmd)) {
+        HANDLER::run(printer, argc, argv);
+        return true;
+      }
+      return StaticCommandRegistry<REST...>::run(cmd, printer, argc, argv);
+    }
+
+    /** Print the usage of the command 'cmd'. Return false if not found. */
+    static bool printHelp(Print& printer, const char* cmd) {
+      if (isName(cmd)) {
+        printer.print(F("Usage: "));
+        printUsage(printer);
+        return true;
+      }
+      return StaticCommandRegistry<REST...>::printHelp(printer, cmd);
+    }
+
+    /** Print the help strings of all commands, one per line. */
+    static void printAllHelp(Print& printer) {
+      printer.print(F("  "));
+      printUsage(printer);
+      StaticCommandRegistry<REST...>::printAllHelp(printer);
+    }
+
+  private:
+    static bool isName(const char* cmd) {
+      return strcmp_P(cmd, (const char*) HANDLER::name()) == 0;
+    }
+
+    static void printUsage(Print& printer) {
+      printer.print(HANDLER::name());
+      if (HANDLER::helpString() != nullptr) {
+        printer.print(' ');
+        printer.print(HANDLER::helpString());
+      }
+      printer.println();
+    }
+};
+
+} // cli
+} // ace_utils
+
+#endif
@@ -0,0 +1,186 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_STATIC_PROCESSOR_MANAGER_H
+#define ACE_UTILS_CLI_STATIC_PROCESSOR_MANAGER_H
+
+#include <string.h> // strcmp()
+#include <Arduino.h> // Stream, Print
+#include "CommandDispatcher.h"
+#include "LineReader.h"
+#include "StaticCommandRegistry.h"
+
+namespace ace_utils {
+namespace cli {
+
+/**
+ * A drop-in alternative to DirectProcessorManager for a fixed set of commands
+ * known at compile time. The commands are given as types to a
+ * StaticCommandRegistry instead of an array of CommandHandler pointers, so
+ * that each dispatch is a direct function call instead of a virtual call.
+ * The input is read and tokenized in the same way as DirectProcessor, and the
+ * built-in `help` command prints the same output.
+ *
+ * Example usage:
+ *
+ * @code
+ * struct CommandA {
+ *   static const __FlashStringHelper* name() { return F("a"); }
+ *   static const __FlashStringHelper* helpString() { return nullptr; }
+ *   static void run(Print& printer, int argc, const char* const* argv) {
+ *     ...
+ *   }
+ * };
+ * struct CommandB {
+ *   ...
+ * };
+ *
+ * const uint8_t BUF_SIZE = 64;
+ * const uint8_t ARGV_SIZE = 5;
+ * const char PROMPT[] = "$ ";
+ *
+ * StaticProcessorManager<BUF_SIZE, ARGV_SIZE, CommandA, CommandB>
+ *     commandManager(Serial, Serial, PROMPT);
+ *
+ * void loop() {
+ *   commandManager.process();
+ * }
+ * @endcode
+ *
+ * @param BUF_SIZE Size of the input line buffer. Can be larger than 255 if
+ *        ACE_UTILS_CLI_WIDE_LINES is set to 1.
+ * @param ARGV_SIZE Size of the command line argv token list.
+ * @param HANDLERS The types of the commands. See StaticCommandRegistry.
+ */
+template<line_size_t BUF_SIZE, uint8_t ARGV_SIZE, typename... HANDLERS>
+class StaticProcessorManager {
+  public:
+    /** The registry of the commands. */
+    typedef StaticCommandRegistry<HANDLERS...> Registry;
+
+    /**
+     * Constructor.
+     *
+     * @param stream The serial port used to read commands.
+     * @param printer output stream, often the same as `stream` but not always
+     * @param prompt Print this prompt just before accepting character inputs.
+     *        If null, don't print the prompt.
+     */
+    StaticProcessorManager(
+        Stream& stream,
+        Print& printer,
+        const char* prompt = nullptr
+    ) :
+        mStream(stream),
+        mPrinter(printer),
+        mLineReader(mLineBuffer, BUF_SIZE),
+        mPrompt(prompt)
+    {}
+
+    /**
+     * Read all the bytes which are available from the input stream, and
+     * execute each complete line.
+     */
+    void process() {
+      if (mPrompt && mShouldPrompt) {
+        mPrinter.print(mPrompt);
+        mPrinter.flush();
+        mShouldPrompt = false;
+      }
+
+      // There could be multiple lines waiting, so loop to get all of them.
+      while (true) {
+        uint8_t status = mLineReader.next();
+        if (status == LineReader::kStatusNone) {
+          if (mLineReader.fill(mStream) == 0) break;
+        } else if (status == LineReader::kStatusLine) {
+          mShouldPrompt = true;
+          runCommand(mLineReader.getLine());
+        } else if (status == LineReader::kStatusOverflow) {
+          mPrinter.println(
+              F("Error: Buffer overflow... flushing until Newline"));
+        } else {
+          mShouldPrompt = true;
+          mPrinter.println(
+              F("Error: Buffer overflow... flushed after Newline"));
+        }
+      }
+    }
+
+    /**
+     * Tokenize the given line and run the matching command, or the built-in
+     * `help` command. VisibleForTesting.
+     */
+    void runCommand(char* line) {
+      uint8_t argc = CommandDispatcher::terminateTokens(line, mArgv, ARGV_SIZE);
+      if (argc == 0) return;
+      const char* cmd = mArgv[0];
+
+      if (strcmp(cmd, "help") == 0) {
+        runHelp(argc);
+      } else if (! Registry::run(cmd, mPrinter, argc, mArgv)) {
+        printUnknown(cmd);
+      }
+    }
+
+  private:
+    // Disable copy-constructor and assignment operator
+    StaticProcessorManager(const StaticProcessorManager&) = delete;
+    StaticProcessorManager& operator=(const StaticProcessorManager&) = delete;
+
+    void runHelp(uint8_t argc) {
+      if (argc == 2) {
+        const char* cmd = mArgv[1];
+        if (strcmp(cmd, "help") == 0) {
+          mPrinter.println(F("Usage: help [command]"));
+        } else if (! Registry::printHelp(mPrinter, cmd)) {
+          printUnknown(cmd);
+        }
+      } else {
+        mPrinter.println(F("Commands:"));
+        mPrinter.println(F("  help [command]"));
+        Registry::printAllHelp(mPrinter);
+      }
+    }
+
+    void printUnknown(const char* cmd) {
+      mPrinter.print(F("Unknown command: '"));
+      mPrinter.print(cmd);
+      mPrinter.println('\'');
+    }
+
+  private:
+    Stream& mStream;
+    Print& mPrinter;
+    LineReader mLineReader;
+    const char* const mPrompt;
+    char mLineBuffer[BUF_SIZE];
+    const char* mArgv[ARGV_SIZE];
+    bool mShouldPrompt = true;
+};
+
+} // cli
+} // ace_utils
+
+#endif
@@ -27,6 +27,11 @@ SOFTWARE.
 
 #include <Arduino.h> // Stream, Print
 #include <AceRoutine.h>
+#include "CommandDispatcher.h"
+#include "FlowControl.h"
+#include "LineReader.h"
+#include "LoopJitter.h"
+#include "ProcessBudget.h"
 
 namespace ace_utils {
 namespace cli {
@@ -38,12 +43,32 @@ namespace cli {
  * line is too long to overflow the line buffer, the rest of the line is flushed
  * until the next '\\n' or '\\r', and an error message is printed on the given
  * Print output.
+ *
+ * The Stream is read in blocks using a LineReader, so all the bytes which are
+ * available are read with a single Stream::readBytes() call, and multiple
+ * commands can be handled in a single iteration of the coroutine.
+ *
+ * If a command is long-running (see CommandHandler::poll()), the coroutine
+ * yields between each poll() until the command finishes, without reading the
+ * following input. If a command has a payload (see
+ * CommandHandler::getPayloadSize()), the bytes which follow the command line
+ * are passed to the command in chunks before it is polled.
+ *
+ * The work done by a single iteration can be limited using setBudget(), in
+ * which case the coroutine yields when the budget is used up, and continues
+ * from the same place when it is resumed.
+ *
+ * An optional FlowControl, set using setFlowControl(), tells the host to stop
+ * sending while the input is backing up in the Stream, and before a command
+ * is run while more input is waiting. It tells the host to resume when the
+ * command has finished and the input has been processed.
+ *
+ * By default, the coroutine polls Stream::available() on every iteration while
+ * it waits for input. If setWakeupEnabled() is called, the coroutine suspends
+ * itself instead, so that the CoroutineScheduler skips it until wakeup() is
+ * called by the code which knows that data has arrived.
  */
 class StreamProcessorCoroutine : public ace_routine::Coroutine {
-  private:
-    static uint8_t const kBufferOk = 0;
-    static uint8_t const kBufferOverflow = 1;
-
   public:
     /**
      * Constructor.
@@ -62,86 +87,239 @@ class StreamProcessorCoroutine : public ace_routine::Coroutine {
         const CommandDispatcher& commandDispatcher,
         Print& printer,
         char* buffer,
-        uint8_t bufferSize,
+        line_size_t bufferSize,
         const char* prompt = nullptr
     ):
         mCommandDispatcher(commandDispatcher),
         mStream(stream),
         mPrinter(printer),
-        mBuf(buffer),
-        mBufSize(bufferSize),
+        mLineReader(buffer, bufferSize),
         mPrompt(prompt)
     {}
 
     /**
-     * Main body of the coroutine that reads a character from the input stream
-     * and writes it into the output channel.
+     * Main body of the coroutine that reads the available bytes from the
+     * input stream and executes each complete line using the
+     * CommandDispatcher.
      */
     int runCoroutine() override {
+      int result = processInput();
+      if (mWakeupEnabled && mAwaitingInput) suspendUntilInput();
+      return result;
+    }
+
+    /**
+     * Limit the work done by a single iteration of the coroutine. See
+     * ProcessBudget. A limit of 0 means unlimited.
+     */
+    void setBudget(uint16_t maxBytes, uint8_t maxCommands, uint32_t maxMicros) {
+      mBudget.setLimits(maxBytes, maxCommands, maxMicros);
+    }
+
+    /** Return the number of times the coroutine yielded early. */
+    uint16_t getNumBudgetHits() const { return mBudget.getNumHits(); }
+
+    /**
+     * Call LoopJitter::markBusy() with the given tag whenever a command is
+     * run, so that the outliers of the loop gap can be attributed to this
+     * processor. Pass nullptr to disable.
+     */
+    void setLoopJitter(LoopJitter* loopJitter, const char* tag) {
+      mLoopJitter = loopJitter;
+      mJitterTag = tag;
+    }
+
+    /**
+     * Tell the host to stop and resume sending using the given FlowControl,
+     * instead of relying on the host to throttle its input. Pass nullptr to
+     * disable.
+     */
+    void setFlowControl(FlowControl* flowControl) {
+      mFlowControl = flowControl;
+    }
+
+    /**
+     * If enabled, the coroutine suspends itself when it has processed all the
+     * input, instead of polling Stream::available(), and wakeup() must be
+     * called when new data arrives, e.g. from serialEvent(), a UART receive
+     * interrupt, or the data callback of a network client. Long-running
+     * commands are still polled on every iteration.
+     */
+    void setWakeupEnabled(bool enabled) {
+      mWakeupEnabled = enabled;
+      if (! enabled) resume();
+    }
+
+    /**
+     * Resume the coroutine suspended by setWakeupEnabled(), because data has
+     * arrived on the Stream. Only writes the status byte of the coroutine,
+     * so it can be called from an interrupt handler. Spurious calls are
+     * harmless.
+     */
+    void wakeup() { resume(); }
+
+  private:
+    // Disable copy-constructor and assignment operator
+    StreamProcessorCoroutine(const StreamProcessorCoroutine&) = delete;
+    StreamProcessorCoroutine& operator=(const StreamProcessorCoroutine&) =
+        delete;
+
+    /** The body of the coroutine, see runCoroutine(). */
+    int processInput() {
+      uint8_t status;
       COROUTINE_LOOP() {
         if (mPrompt && mShouldPrompt) {
           mPrinter.print(mPrompt);
           mPrinter.flush();
           mShouldPrompt = false;
         }
+        mAwaitingInput = true;
         COROUTINE_AWAIT(mStream.available() > 0);
+        mAwaitingInput = false;
+        mBudget.start();
 
-        // There could be multiple bytes waiting, so loop to get all of them.
-        while (mStream.available() > 0) {
-          char c = mStream.read();
-          mBuf[mIndex] = c;
-          mIndex++;
+        // There could be multiple lines waiting, so loop to get all of them.
+        while (true) {
+          if (mBudget.isExhausted()) {
+            if (! hasInput()) break;
+            // The lines left in the line buffer are not visible in the
+            // available() of the Stream, so keep the host stopped.
+            mBudget.recordHit();
+            updateFlowControl(true);
+            COROUTINE_YIELD();
+            mBudget.start();
+          }
 
-          if (mIndex >= mBufSize - 1) {
-            resetBuffer();
+          status = mLineReader.next();
+          if (status == LineReader::kStatusNone) {
+            uint8_t n = mLineReader.fill(mStream, mBudget.getByteAllowance());
+            if (n == 0) break;
+            mBudget.addBytes(n);
+          } else if (status == LineReader::kStatusLine) {
+            mShouldPrompt = true;
+            mBudget.addCommand();
+            markBusy();
+            pauseIfInputPending();
+            mActiveCommand =
+                mCommandDispatcher.runCommand(mPrinter, mLineReader.getLine());
+            if (mActiveCommand != nullptr) {
+              mPayloadRemaining = mActiveCommand->getPayloadSize();
+              // Each resumption gets a new budget.
+              while (! pollActiveCommand()) {
+                COROUTINE_YIELD();
+                mBudget.start();
+              }
+            }
+          } else if (status == LineReader::kStatusOverflow) {
+            mCommandDispatcher.recordOverflow();
             mPrinter.println(
                 F("Error: Buffer overflow... flushing until Newline"));
-            mBufStatus = kBufferOverflow;
-          } else if (c == '\n' || c == '\r') {
-            resetBuffer();
+          } else {
+            // If the buffer had previously overflown, then flush all input
+            // until the \n or \r.
             mShouldPrompt = true;
-
-            if (mBufStatus == kBufferOk) {
-              mCommandDispatcher.runCommand(mPrinter, mBuf);
-            } else {
-              // If the buffer had previously overflown, then flush all input
-              // until the \n or \r.
-              mPrinter.println(
-                  F("Error: Buffer overflow... flushed after Newline"));
-              mBufStatus = kBufferOk;
-            }
+            mPrinter.println(
+                F("Error: Buffer overflow... flushed after Newline"));
           }
         }
+        updateFlowControl(false);
       }
     }
 
-  private:
-    // Disable copy-constructor and assignment operator
-    StreamProcessorCoroutine(const StreamProcessorCoroutine&) = delete;
-    StreamProcessorCoroutine& operator=(const StreamProcessorCoroutine&) =
-        delete;
+    /**
+     * Suspend the coroutine until wakeup() is called. If the data arrived
+     * before suspend(), the wakeup() was a no-op, so check the Stream once
+     * more to avoid sleeping with input pending.
+     */
+    void suspendUntilInput() {
+      suspend();
+      if (mStream.available() > 0) resume();
+    }
+
+    void markBusy() {
+      if (mLoopJitter) mLoopJitter->markBusy(mJitterTag);
+    }
 
     /**
-     * Terminate the current buffer with the NUL character (so that the current
-     * string can be retrieved), and reset the character index to the beginning
-     * of the buffer to prepare for the next mStream.read();
+     * Pass the payload to the active command, then continue the long-running
+     * command. Return true when finished.
      */
-    void resetBuffer() {
-      mBuf[mIndex] = '\0';
-      mIndex = 0;
+    bool pollActiveCommand() {
+      markBusy();
+      if (mPayloadRemaining > 0) {
+        receivePayload();
+        updateFlowControl(false);
+        if (mPayloadRemaining > 0) return false;
+      }
+      bool done = mCommandDispatcher.pollHandler(mPrinter, mActiveCommand);
+      // When the command is done, the host is told to resume only after the
+      // input which is waiting in the line buffer has been processed.
+      if (! done) updateFlowControl(true);
+      return done;
+    }
+
+    /** Update the FlowControl, if any. */
+    void updateFlowControl(bool busy) {
+      if (mFlowControl) mFlowControl->update(mStream.available(), busy);
+    }
+
+    /**
+     * Tell the host to stop if more input is waiting, because the input is
+     * not read while the command runs. See DirectProcessor.
+     */
+    void pauseIfInputPending() {
+      if (mFlowControl && hasInput()) {
+        mFlowControl->update(mStream.available(), true);
+      }
+    }
+
+    /**
+     * Pass the payload bytes which are available to the active command, in
+     * chunks of at most 255 bytes, using the line buffer. Stops after a chunk
+     * if the budget is used up.
+     */
+    void receivePayload() {
+      while (mPayloadRemaining > 0) {
+        char* data;
+        uint8_t maxBytes =
+            (mPayloadRemaining > 255) ? 255 : (uint8_t) mPayloadRemaining;
+        uint8_t n = mLineReader.takePending(data, maxBytes);
+        if (n == 0) {
+          n = mLineReader.fill(mStream, mBudget.getByteAllowance());
+          if (n == 0) return;
+          mBudget.addBytes(n);
+          continue;
+        }
+        mCommandDispatcher.payloadHandler(mPrinter, mActiveCommand, data, n);
+        mPayloadRemaining -= n;
+        if (mPayloadRemaining > 0 && mBudget.isExhausted()) {
+          if (hasInput()) mBudget.recordHit();
+          return;
+        }
+      }
+    }
+
+    /** Return true if there is more input to process. */
+    bool hasInput() {
+      return mLineReader.hasPending() || mStream.available() > 0;
     }
 
   private:
     const CommandDispatcher& mCommandDispatcher;
     Stream& mStream;
     Print& mPrinter;
-    char* const mBuf;
-    uint8_t const mBufSize;
+    LineReader mLineReader;
+    ProcessBudget mBudget;
     const char* const mPrompt;
+    const CommandHandler* mActiveCommand = nullptr;
+    uint32_t mPayloadRemaining = 0;
+    LoopJitter* mLoopJitter = nullptr;
+    const char* mJitterTag = nullptr;
+    FlowControl* mFlowControl = nullptr;
 
-    uint8_t mIndex = 0;
-    uint8_t mBufStatus = kBufferOk;
     bool mShouldPrompt = true;
+    bool mWakeupEnabled = false;
+    bool mAwaitingInput = false;
 };
 
 } // cli
@@ -80,10 +80,11 @@ namespace cli {
  * }
  * @endcode
  *
- * @param BUF_SIZE Size of the input line buffer.
+ * @param BUF_SIZE Size of the input line buffer. Can be larger than 255 if
+ *        ACE_UTILS_CLI_WIDE_LINES is set to 1.
  * @param ARGV_SIZE Size of the command line argv token list.
  */
-template<uint8_t BUF_SIZE, uint8_t ARGV_SIZE>
+template<line_size_t BUF_SIZE, uint8_t ARGV_SIZE>
 class StreamProcessorManager {
   public:
 
@@ -105,7 +106,8 @@ class StreamProcessorManager {
         Print& printer,
         const char* prompt = nullptr
     ) :
-        mCommandDispatcher(commands, numCommands, mArgv, ARGV_SIZE),
+        mCommandDispatcher(commands, numCommands, mArgv, ARGV_SIZE,
+            nullptr /*sortedIndex*/, mTokens, BUF_SIZE),
         mStreamProcessor(
             stream, mCommandDispatcher, printer, mLineBuffer, BUF_SIZE, prompt)
     {}
@@ -115,6 +117,22 @@ class StreamProcessorManager {
       return mStreamProcessor;
     }
 
+    /**
+     * Return the underlying CommandDispatcher, e.g. to create a BoundCommand
+     * or to give it to a WatchManager.
+     */
+    const CommandDispatcher& getCommandDispatcher() const {
+      return mCommandDispatcher;
+    }
+
+    /**
+     * Give the ScratchArena to the commands, see
+     * CommandDispatcher::setScratchArena().
+     */
+    void setScratchArena(ScratchArena* arena) {
+      mCommandDispatcher.setScratchArena(arena);
+    }
+
   private:
     // Disable copy-constructor and assignment operator
     StreamProcessorManager(const StreamProcessorManager&) = delete;
@@ -125,6 +143,7 @@ class StreamProcessorManager {
     StreamProcessorCoroutine mStreamProcessor;
     char mLineBuffer[BUF_SIZE];
     const char* mArgv[ARGV_SIZE];
+    char mTokens[BUF_SIZE];
 };
 
 } // cli
@@ -27,6 +27,7 @@ SOFTWARE.
 
 #include <Arduino.h> // Stream
 #include <AceRoutine.h>
+#include "FlowControl.h"
 #include "InputLine.h"
 
 namespace ace_utils {
@@ -36,6 +37,14 @@ namespace cli {
  * An AceRoutine coroutine that reads lines (terminated by '\\n' or '\\r' from
  * the Stream device, and write the InputLine message into the provided
  * Channel. The Stream will normally be the global Serial object.
+ *
+ * An optional FlowControl, set using setFlowControl(), tells the host to stop
+ * sending while the input is backing up in the Stream, e.g. while the
+ * reader waits for the processor to accept the line from the Channel.
+ *
+ * If setWakeupEnabled() is called, the coroutine suspends itself while it
+ * waits for input, instead of polling Stream::available(), until wakeup() is
+ * called. See StreamProcessorCoroutine::setWakeupEnabled().
  */
 class StreamReaderCoroutine : public ace_routine::Coroutine {
   public:
@@ -66,11 +75,49 @@ class StreamReaderCoroutine : public ace_routine::Coroutine {
      * and writes it into the output channel.
      */
     int runCoroutine() override {
+      int result = readInput();
+      if (mWakeupEnabled && mAwaitingInput) suspendUntilInput();
+      return result;
+    }
+
+    /**
+     * Tell the host to stop and resume sending using the given FlowControl,
+     * instead of relying on the host to throttle its input. Pass nullptr to
+     * disable.
+     */
+    void setFlowControl(FlowControl* flowControl) {
+      mFlowControl = flowControl;
+    }
+
+    /**
+     * If enabled, the coroutine suspends itself when the Stream is empty, and
+     * wakeup() must be called when new data arrives.
+     */
+    void setWakeupEnabled(bool enabled) {
+      mWakeupEnabled = enabled;
+      if (! enabled) resume();
+    }
+
+    /**
+     * Resume the coroutine suspended by setWakeupEnabled(). Can be called
+     * from an interrupt handler.
+     */
+    void wakeup() { resume(); }
+
+  private:
+    // Disable copy-constructor and assignment operator
+    StreamReaderCoroutine (const StreamReaderCoroutine &) = delete;
+    StreamReaderCoroutine & operator=(const StreamReaderCoroutine &) = delete;
+
+    /** The body of the coroutine, see runCoroutine(). */
+    int readInput() {
       InputLine input;
       char c;
 
       COROUTINE_LOOP() {
+        mAwaitingInput = true;
         COROUTINE_AWAIT(mStream.available() > 0);
+        mAwaitingInput = false;
 
         while (mStream.available() > 0) {
           c = mStream.read();
@@ -81,6 +128,7 @@ class StreamReaderCoroutine : public ace_routine::Coroutine {
             input.line = mBuf;
             mFlushLine = true;
             resetBuffer();
+            pauseIfInputPending();
             COROUTINE_CHANNEL_WRITE(mChannel, input);
           } else if (c == '\n' || c == '\r') {
             input.status =
@@ -88,16 +136,22 @@ class StreamReaderCoroutine : public ace_routine::Coroutine {
             input.line = mBuf;
             mFlushLine = false;
             resetBuffer();
+            pauseIfInputPending();
             COROUTINE_CHANNEL_WRITE(mChannel, input);
           }
         }
+        updateFlowControl();
       }
     }
 
-  private:
-    // Disable copy-constructor and assignment operator
-    StreamReaderCoroutine (const StreamReaderCoroutine &) = delete;
-    StreamReaderCoroutine & operator=(const StreamReaderCoroutine &) = delete;
+    /**
+     * Suspend the coroutine until wakeup() is called, unless the data
+     * arrived before suspend().
+     */
+    void suspendUntilInput() {
+      suspend();
+      if (mStream.available() > 0) resume();
+    }
 
     /**
      * Terminate the current buffer with the NUL character (so that the current
@@ -109,6 +163,22 @@ class StreamReaderCoroutine : public ace_routine::Coroutine {
       mIndex = 0;
     }
 
+    /** Update the FlowControl, if any. */
+    void updateFlowControl() {
+      if (mFlowControl) mFlowControl->update(mStream.available(), false);
+    }
+
+    /**
+     * Tell the host to stop if more input is waiting, because the Stream is
+     * not read while this coroutine is blocked in the channel write, which
+     * lasts until the command of the line has run.
+     */
+    void pauseIfInputPending() {
+      if (mFlowControl && mStream.available() > 0) {
+        mFlowControl->update(mStream.available(), true);
+      }
+    }
+
   private:
     ace_routine::Channel<InputLine>& mChannel;
     Stream& mStream;
@@ -116,7 +186,10 @@ class StreamReaderCoroutine : public ace_routine::Coroutine {
     int const mBufSize;
 
     int mIndex = 0;
+    FlowControl* mFlowControl = nullptr;
     bool mFlushLine = false;
+    bool mWakeupEnabled = false;
+    bool mAwaitingInput = false;
 };
 
 } // cli
@@ -0,0 +1,52 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_TOKEN_SPAN_H
+#define ACE_UTILS_CLI_TOKEN_SPAN_H
+
+#include <stdint.h>
+#include "LineReader.h" // line_size_t
+
+namespace ace_utils {
+namespace cli {
+
+/**
+ * Location of a single token inside an input line, as returned by
+ * CommandDispatcher::tokenizeSpans(). The line itself is not modified, so
+ * the token is *not* NUL-terminated. The offset and length have the same type
+ * as the size of the line buffers of the processors, which is a `uint16_t`
+ * if ACE_UTILS_CLI_WIDE_LINES is enabled, and a `uint8_t` otherwise.
+ */
+struct TokenSpan {
+  /** Offset of the first character of the token from the start of line. */
+  line_size_t offset;
+
+  /** Number of characters in the token. */
+  line_size_t length;
+};
+
+} // cli
+} // ace_utils
+
+#endif
@@ -0,0 +1,60 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <stdlib.h> // strtol()
+#include <Arduino.h> // Print, F()
+#include "WatchCommand.h"
+
+namespace ace_utils {
+namespace cli {
+
+WatchCommand::WatchCommand(WatchCoroutine& watchCoroutine):
+    CommandHandler(F("watch"), F("[millis command [args ...]]")),
+    mWatchCoroutine(watchCoroutine)
+{}
+
+void WatchCommand::run(Print& printer, int argc, const char* const* argv)
+    const {
+  if (argc == 1) {
+    mWatchCoroutine.stop();
+    return;
+  }
+
+  char* end;
+  long interval = (argc >= 3) ? strtol(argv[1], &end, 10) : 0;
+  if (interval <= 0 || interval > 65535 || *end != '\0') {
+    printer.println(F("Usage: watch [millis command [args ...]]"));
+    return;
+  }
+  if (isArgEqual(argv[2], F("watch"))) {
+    printer.println(F("Error: Cannot watch 'watch'"));
+    return;
+  }
+  if (! mWatchCoroutine.start(interval, argc - 2, argv + 2)) {
+    printer.println(F("Error: Command too long"));
+  }
+}
+
+} // cli
+} // ace_utils
@@ -0,0 +1,102 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <Arduino.h> // Print, F()
+#include "WatchCoroutine.h"
+
+namespace ace_utils {
+namespace cli {
+
+bool WatchCoroutine::start(uint16_t intervalMillis, int argc,
+    const char* const* argv) {
+  stop();
+  if (mDispatcher == nullptr || argc == 0) return false;
+
+  // Join the tokens into the line buffer.
+  uint8_t len = 0;
+  for (int i = 0; i < argc; i++) {
+    size_t tokenLen = strlen(argv[i]);
+    if (len + tokenLen + 1 > mLineSize) return false;
+    memcpy(mLine + len, argv[i], tokenLen);
+    len += tokenLen;
+    mLine[len++] = ' ';
+  }
+  mLine[len - 1] = '\0';
+
+  mArgc = CommandDispatcher::terminateTokens(mLine, mArgv, mArgvSize);
+  mCommand = CommandDispatcher::isBuiltinCommand(mArgv[0])
+      ? nullptr
+      : mDispatcher->findCommand(mArgv[0]);
+  mPrevious[0] = '\0';
+  mIntervalMillis = intervalMillis;
+  mWatching = true;
+  return true;
+}
+
+void WatchCoroutine::runOnce() {
+  if (! mWatching) return;
+
+  CapturePrint capture(mCurrent, mCaptureSize);
+  if (mCommand != nullptr) {
+    mDispatcher->runHandler(capture, mCommand, mArgc, mArgv);
+  } else {
+    // Built-in, ProgmemCommand or unknown command.
+    mDispatcher->runTokens(capture, mArgc, mArgv);
+  }
+  mNumBytesCaptured += capture.terminate();
+
+  printChanges();
+
+  char* tmp = mPrevious;
+  mPrevious = mCurrent;
+  mCurrent = tmp;
+}
+
+void WatchCoroutine::printChanges() {
+  const char* current = mCurrent;
+  const char* previous = mPrevious;
+  uint8_t index = 0;
+  while (*current != '\0' || *previous != '\0') {
+    bool currentExists = (*current != '\0');
+    bool previousExists = (*previous != '\0');
+    const char* currentLine = current;
+    const char* previousLine = previous;
+    uint16_t currentLen = lineLength(currentLine, current);
+    uint16_t previousLen = lineLength(previousLine, previous);
+
+    bool same = currentExists == previousExists
+        && currentLen == previousLen
+        && memcmp(currentLine, previousLine, currentLen) == 0;
+    if (! same) {
+      mNumBytesSent += mPrinter.print(index);
+      mNumBytesSent += mPrinter.print(':');
+      mNumBytesSent += mPrinter.write(currentLine, currentLen);
+      mNumBytesSent += mPrinter.println();
+    }
+    index++;
+  }
+}
+
+} // cli
+} // ace_utils
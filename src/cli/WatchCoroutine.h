@@ -0,0 +1,203 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_WATCH_COROUTINE_H
+#define ACE_UTILS_CLI_WATCH_COROUTINE_H
+
+#include <string.h> // memcmp()
+#include <Arduino.h> // Print
+#include <AceRoutine.h>
+#include "CommandDispatcher.h"
+
+namespace ace_utils {
+namespace cli {
+
+/**
+ * An AceRoutine coroutine which runs a command periodically, captures its
+ * output into a buffer, and prints only the lines which changed since the
+ * previous run. This reduces the bandwidth used by a dashboard which monitors
+ * the output of a status command over a slow serial link. Normally controlled
+ * through the WatchCommand, and created by a WatchManager.
+ *
+ * Each changed line is printed as "N:text", where N is the 0-based index of
+ * the line in the output. A line which disappeared is printed as "N:". All
+ * the lines are printed on the first run. The output of the command which
+ * does not fit in the capture buffer is dropped.
+ *
+ * The changes are printed to the Print given to the constructor, not to the
+ * Print of the WatchCommand, which is valid only while the WatchCommand runs
+ * (e.g. a CountingPrint on the stack, or the response of a FrameProcessor).
+ *
+ * Long-running commands (see CommandHandler::poll()) are not supported; only
+ * their run() method is called.
+ */
+class WatchCoroutine : public ace_routine::Coroutine {
+  public:
+    /**
+     * Constructor.
+     *
+     * @param printer output of the changed lines, usually the global Serial
+     * @param line buffer which holds a copy of the watched command line
+     * @param lineSize size of 'line'
+     * @param argv array which holds the tokens of 'line'
+     * @param argvSize size of 'argv'
+     * @param current capture buffer of the current run
+     * @param previous capture buffer of the previous run
+     * @param captureSize size of each capture buffer
+     */
+    WatchCoroutine(
+        Print& printer,
+        char* line,
+        uint8_t lineSize,
+        const char** argv,
+        uint8_t argvSize,
+        char* current,
+        char* previous,
+        uint16_t captureSize
+    ):
+        mPrinter(printer),
+        mLine(line),
+        mArgv(argv),
+        mCurrent(current),
+        mPrevious(previous),
+        mCaptureSize(captureSize),
+        mLineSize(lineSize),
+        mArgvSize(argvSize)
+    {}
+
+    /**
+     * Set the CommandDispatcher which runs the watched command, normally the
+     * one of the processor which runs the WatchCommand. Must be called before
+     * start().
+     */
+    void setDispatcher(const CommandDispatcher* dispatcher) {
+      mDispatcher = dispatcher;
+    }
+
+    /**
+     * Start watching the command given by the tokens in argv, every
+     * 'intervalMillis'. The tokens are copied. Return false if there is no
+     * dispatcher, or the tokens do not fit into the line buffer.
+     */
+    bool start(uint16_t intervalMillis, int argc, const char* const* argv);
+
+    /** Stop watching. */
+    void stop() { mWatching = false; }
+
+    /** Return true if a command is being watched. */
+    bool isWatching() const { return mWatching; }
+
+    /** Return the total number of bytes written by the command. */
+    uint32_t getNumBytesCaptured() const { return mNumBytesCaptured; }
+
+    /** Return the total number of bytes printed for the changed lines. */
+    uint32_t getNumBytesSent() const { return mNumBytesSent; }
+
+    /** Main body of the coroutine. */
+    int runCoroutine() override {
+      COROUTINE_LOOP() {
+        COROUTINE_AWAIT(mWatching);
+        runOnce();
+        COROUTINE_DELAY(mIntervalMillis);
+      }
+    }
+
+    /**
+     * Run the command once, and print the lines which changed.
+     * VisibleForTesting.
+     */
+    void runOnce();
+
+  private:
+    /** A Print which writes into a capture buffer, dropping the overflow. */
+    class CapturePrint: public Print {
+      public:
+        CapturePrint(char* buffer, uint16_t size):
+            mBuffer(buffer),
+            mSize(size)
+        {}
+
+        size_t write(uint8_t c) override {
+          if (mLen + 1 >= mSize) return 0;
+          mBuffer[mLen++] = c;
+          return 1;
+        }
+
+        using Print::write;
+
+        /** NUL-terminate the buffer and return the length of the output. */
+        uint16_t terminate() {
+          mBuffer[mLen] = '\0';
+          return mLen;
+        }
+
+      private:
+        char* const mBuffer;
+        uint16_t const mSize;
+        uint16_t mLen = 0;
+    };
+
+    // Disable copy-constructor and assignment operator
+    WatchCoroutine(const WatchCoroutine&) = delete;
+    WatchCoroutine& operator=(const WatchCoroutine&) = delete;
+
+    /** Print the lines of mCurrent which differ from mPrevious. */
+    void printChanges();
+
+    /**
+     * Return the length of the line at 's', not including the terminator,
+     * and set 'next' to the start of the following line.
+     */
+    static uint16_t lineLength(const char* s, const char*& next) {
+      const char* p = s;
+      while (*p != '\0' && *p != '\r' && *p != '\n') p++;
+      uint16_t len = p - s;
+      if (*p == '\r') p++;
+      if (*p == '\n') p++;
+      next = p;
+      return len;
+    }
+
+  private:
+    const CommandDispatcher* mDispatcher = nullptr;
+    const CommandHandler* mCommand = nullptr;
+    Print& mPrinter;
+    char* const mLine;
+    const char** const mArgv;
+    char* mCurrent;
+    char* mPrevious;
+    uint32_t mNumBytesCaptured = 0;
+    uint32_t mNumBytesSent = 0;
+    uint16_t const mCaptureSize;
+    uint16_t mIntervalMillis = 0;
+    uint8_t const mLineSize;
+    uint8_t const mArgvSize;
+    uint8_t mArgc = 0;
+    bool mWatching = false;
+};
+
+} // cli
+} // ace_utils
+
+#endif
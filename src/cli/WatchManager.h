@@ -0,0 +1,109 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef ACE_UTILS_CLI_WATCH_MANAGER_H
+#define ACE_UTILS_CLI_WATCH_MANAGER_H
+
+#include "WatchCommand.h"
+#include "WatchCoroutine.h"
+
+namespace ace_utils {
+namespace cli {
+
+/**
+ * A convenience wrapper which creates the buffers of a WatchCoroutine and
+ * its WatchCommand. The WatchCommand is added to the COMMANDS array, and the
+ * CommandDispatcher of the processor is given to the WatchCoroutine in
+ * setup(), because the processor is created after the COMMANDS array. Every
+ * processor manager returns its CommandDispatcher from getCommandDispatcher().
+ *
+ * Example usage:
+ *
+ * @code
+ * WatchManager<32, 4, 128> watchManager(Serial);
+ *
+ * static const CommandHandler* const COMMANDS[] = {
+ *   &statusCommand,
+ *   &watchManager.getWatchCommand(),
+ * };
+ *
+ * StreamProcessorManager<BUF_SIZE, ARGV_SIZE> commandManager(
+ *     Serial, COMMANDS, NUM_COMMANDS, Serial, PROMPT);
+ *
+ * void setup() {
+ *   ...
+ *   watchManager.setDispatcher(&commandManager.getCommandDispatcher());
+ *   CoroutineScheduler::setup();
+ * }
+ * @endcode
+ *
+ * @param LINE_SIZE Size of the copy of the watched command line.
+ * @param ARGV_SIZE Size of the argv token list of the watched command.
+ * @param CAPTURE_SIZE Size of each of the 2 capture buffers, which must hold
+ *        the whole output of the watched command.
+ */
+template<uint8_t LINE_SIZE, uint8_t ARGV_SIZE, uint16_t CAPTURE_SIZE>
+class WatchManager {
+  public:
+    /**
+     * Constructor.
+     *
+     * @param printer output of the changed lines, usually the same as the
+     *        printer of the processor which runs the WatchCommand
+     */
+    explicit WatchManager(Print& printer):
+        mWatchCoroutine(printer, mLine, LINE_SIZE, mArgv, ARGV_SIZE,
+            mCapture0, mCapture1, CAPTURE_SIZE),
+        mWatchCommand(mWatchCoroutine)
+    {}
+
+    /** Set the CommandDispatcher which runs the watched command. */
+    void setDispatcher(const CommandDispatcher* dispatcher) {
+      mWatchCoroutine.setDispatcher(dispatcher);
+    }
+
+    /** Return the WatchCommand, to be added to the COMMANDS array. */
+    const WatchCommand& getWatchCommand() const { return mWatchCommand; }
+
+    /** Return the WatchCoroutine. */
+    WatchCoroutine& getWatchCoroutine() { return mWatchCoroutine; }
+
+  private:
+    // Disable copy-constructor and assignment operator
+    WatchManager(const WatchManager&) = delete;
+    WatchManager& operator=(const WatchManager&) = delete;
+
+  private:
+    WatchCoroutine mWatchCoroutine;
+    WatchCommand mWatchCommand;
+    char mLine[LINE_SIZE];
+    const char* mArgv[ARGV_SIZE];
+    char mCapture0[CAPTURE_SIZE];
+    char mCapture1[CAPTURE_SIZE];
+};
+
+} // cli
+} // ace_utils
+
+#endif
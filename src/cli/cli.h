@@ -2,14 +2,43 @@
 #define ACE_UTILS_CLI_H
 
 #include "CommandHandler.h"
+#include "ProgmemCommand.h"
+#include "NumberFormat.h"
+#include "ArgSchema.h"
+#include "SchemaCommandHandler.h"
+#include "TokenSpan.h"
 #include "CommandDispatcher.h"
+#include "ArenaCommandHandler.h"
+#include "BoundCommand.h"
 #include "InputLine.h"
+#include "LineReader.h"
+#include "BufferedPrint.h"
+#include "RingBufferStream.h"
+#include "BufferedPrintCoroutine.h"
+#include "FlowControl.h"
+#include "ProcessBudget.h"
+#include "LoopJitter.h"
+#include "JitterCommand.h"
+#include "EventLog.h"
+#include "EventLogCommand.h"
+#include "WatchCoroutine.h"
+#include "WatchCommand.h"
+#include "WatchManager.h"
 #include "StreamReaderCoroutine.h"
 #include "ChannelProcessorCoroutine.h"
 #include "ChannelProcessorManager.h"
+#include "LineQueue.h"
+#include "QueueReaderCoroutine.h"
+#include "QueueProcessorCoroutine.h"
+#include "QueueProcessorManager.h"
 #include "StreamProcessorCoroutine.h"
 #include "StreamProcessorManager.h"
 #include "DirectProcessor.h"
 #include "DirectProcessorManager.h"
+#include "StaticCommandRegistry.h"
+#include "StaticProcessorManager.h"
+#include "LineBufferPool.h"
+#include "SessionProcessor.h"
+#include "SessionProcessorManager.h"
 
 #endif
@@ -0,0 +1,321 @@
+#line 2 "CliHostTest.ino"
+
+/*
+ * Tests of the cli/ library which need the host operating system, e.g.
+ * threads and sockets, so they run only on EpoxyDuino. On a real board, no
+ * tests are compiled.
+ */
+
+#include <Arduino.h> // Print
+#include <AUnitVerbose.h>
+#include <AceUtils.h>
+#include <cli/cli.h> // from AceUtils.h
+#if defined(EPOXY_DUINO)
+  #include <thread>
+#endif
+#if defined(EPOXY_DUINO) && defined(__linux__)
+  #include <stdio.h> // snprintf()
+  #include <unistd.h> // getpid()
+  #include <sys/socket.h>
+  #include <sys/un.h>
+  #include <cli/FdServer.h> // from AceUtils.h
+#endif
+
+using aunit::TestRunner;
+using ace_utils::cli::CommandHandler;
+
+// ---------------------------------------------------------------------------
+
+const uint8_t BUF_SIZE = 64;
+const uint8_t ARGV_SIZE = 4;
+
+/** Print each argv token, surrounded by brackets. */
+class ArgsCommand: public CommandHandler {
+  public:
+    ArgsCommand(): CommandHandler("args", nullptr) {}
+
+    void run(Print& printer, int argc, const char* const* argv)
+        const override {
+      for (int i = 0; i < argc; i++) {
+        printer.print('[');
+        printer.print(argv[i]);
+        printer.print(']');
+      }
+    }
+};
+
+/** Print 'fill' followed by 1000 bytes of 'x', and count the runs. */
+class FillCommand: public CommandHandler {
+  public:
+    FillCommand(): CommandHandler("fill", nullptr) {}
+
+    void run(Print& printer, int /*argc*/, const char* const* /*argv*/)
+        const override {
+      mNumRuns++;
+      char line[100];
+      memset(line, 'x', sizeof(line));
+      for (uint8_t i = 0; i < 10; i++) printer.write(line, sizeof(line));
+    }
+
+    mutable uint16_t mNumRuns = 0;
+};
+
+static ArgsCommand argsCommand;
+static FillCommand fillCommand;
+static const CommandHandler* const ARGS_COMMANDS[] = {
+  &argsCommand,
+  &fillCommand,
+};
+
+#if defined(EPOXY_DUINO)
+
+using ace_utils::cli::RingBufferStream;
+
+// A producer thread which emulates the firehose of an RX interrupt.
+test(RingBufferStream_producerThread) {
+  static const uint32_t kNumBytes = 100000;
+  uint8_t buf[64];
+  RingBufferStream ring(buf, sizeof(buf));
+
+  // The producer waits for room, so no byte is lost.
+  std::thread producer([&ring]() {
+    for (uint32_t i = 0; i < kNumBytes; i++) {
+      while (ring.availableForWrite() == 0) {}
+      ring.put((uint8_t) i);
+    }
+  });
+  uint32_t numErrors = 0;
+  for (uint32_t i = 0; i < kNumBytes; ) {
+    int c = ring.read();
+    if (c < 0) continue;
+    if (c != (uint8_t) i) numErrors++;
+    i++;
+  }
+  producer.join();
+  assertEqual(numErrors, (uint32_t) 0);
+  assertEqual(ring.getNumOverruns(), (uint32_t) 0);
+  assertLessOrEqual(ring.getHighWater(), (uint16_t) sizeof(buf));
+
+  // The producer never waits, so bytes are dropped, but each byte is either
+  // received or counted.
+  std::thread firehose([&ring]() {
+    for (uint32_t i = 0; i < kNumBytes; i++) ring.put((uint8_t) i);
+  });
+  uint32_t numReceived = 0;
+  while (numReceived + ring.getNumOverruns() < kNumBytes) {
+    if (ring.read() >= 0) numReceived++;
+  }
+  firehose.join();
+  assertEqual(ring.available(), 0);
+  assertEqual(numReceived + ring.getNumOverruns(), kNumBytes);
+  assertEqual(ring.getHighWater(), (uint16_t) sizeof(buf));
+}
+
+#endif
+
+#if defined(EPOXY_DUINO) && defined(__linux__)
+
+using ace_utils::cli::FdServer;
+
+// Many scripted clients on a Unix-domain socket, sharing 4 line buffers.
+test(FdServer_manyClients) {
+  static const uint16_t kNumClients = 200;
+  static FdServer<BUF_SIZE, ARGV_SIZE, 4, kNumClients> server(
+      ARGS_COMMANDS, 2);
+
+  char path[64];
+  snprintf(path, sizeof(path), "/tmp/CliHostTest-%d.sock", (int) getpid());
+  assertTrue(server.listen(path));
+
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+  int fds[kNumClients];
+  char expected[kNumClients][16];
+  uint8_t received[kNumClients];
+  for (uint16_t i = 0; i < kNumClients; i++) {
+    fds[i] = socket(AF_UNIX, SOCK_STREAM, 0);
+    assertEqual(connect(fds[i], (struct sockaddr*) &addr, sizeof(addr)), 0);
+    char line[16];
+    snprintf(line, sizeof(line), "args %u\n", i);
+    assertEqual(write(fds[i], line, strlen(line)), (ssize_t) strlen(line));
+    snprintf(expected[i], sizeof(expected[i]), "[args][%u]", i);
+    received[i] = 0;
+    server.process();
+  }
+
+  // Collect the responses without blocking.
+  uint16_t numDone = 0;
+  for (uint16_t pass = 0; pass < 1000 && numDone < kNumClients; pass++) {
+    server.process(1);
+    for (uint16_t i = 0; i < kNumClients; i++) {
+      size_t len = strlen(expected[i]);
+      if (received[i] == len) continue;
+      char response[16];
+      ssize_t n = recv(fds[i], response, len - received[i], MSG_DONTWAIT);
+      if (n <= 0) continue;
+      assertEqual(memcmp(response, expected[i] + received[i], n), 0);
+      received[i] += n;
+      if (received[i] == len) numDone++;
+    }
+  }
+  assertEqual(numDone, kNumClients);
+  assertEqual(server.getNumAccepted(), (uint32_t) kNumClients);
+  assertEqual(server.getNumClients(), kNumClients);
+  assertEqual(server.getBufferPool().getNumFree(), 4);
+
+  // The clients disconnect.
+  for (uint16_t i = 0; i < kNumClients; i++) close(fds[i]);
+  for (uint8_t pass = 0; pass < 100 && server.getNumClients() > 0; pass++) {
+    server.process(1);
+  }
+  assertEqual(server.getNumClients(), (uint16_t) 0);
+
+  server.close();
+  unlink(path);
+}
+
+// A partial line must not keep the client pending, so that process() blocks
+// in epoll_wait() until the rest of the line arrives.
+test(FdServer_partialLineBlocks) {
+  FdServer<BUF_SIZE, ARGV_SIZE, 2, 2> server(ARGS_COMMANDS, 2);
+
+  int fds[2];
+  assertEqual(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds), 0);
+  assertTrue(server.addClient(fds[0]));
+
+  const char partial[] = "args a";
+  assertEqual(write(fds[1], partial, strlen(partial)),
+      (ssize_t) strlen(partial));
+  server.process();
+  assertEqual(server.getBufferPool().getNumFree(), 1);
+
+  unsigned long startMillis = millis();
+  server.process(50);
+  assertMore(millis() - startMillis, 40UL);
+
+  assertEqual(write(fds[1], "\n", 1), (ssize_t) 1);
+  server.process(50);
+  char response[16];
+  ssize_t n = recv(fds[1], response, sizeof(response) - 1, MSG_DONTWAIT);
+  assertMore(n, (ssize_t) 0);
+  response[n] = '\0';
+  assertEqual(response, "[args][a]");
+  assertEqual(server.getBufferPool().getNumFree(), 2);
+
+  server.close();
+  close(fds[1]);
+}
+
+// A client which does not read its output is not served until the output
+// drains, and every output byte is either received or counted as dropped.
+test(FdServer_outputBackpressure) {
+  static const uint16_t kNumLines = 40;
+  FdServer<BUF_SIZE, ARGV_SIZE, 2, 2> server(ARGS_COMMANDS, 2);
+
+  int fds[2];
+  assertEqual(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds), 0);
+  int sendBufferSize = 4096;
+  setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &sendBufferSize,
+      sizeof(sendBufferSize));
+  assertTrue(server.addClient(fds[0]));
+
+  fillCommand.mNumRuns = 0;
+  for (uint16_t i = 0; i < kNumLines; i++) {
+    assertEqual(write(fds[1], "fill\n", 5), (ssize_t) 5);
+  }
+  for (uint8_t i = 0; i < 10; i++) server.process();
+  uint16_t numRuns = fillCommand.mNumRuns;
+  assertLess(numRuns, kNumLines);
+
+  // Waiting for EPOLLOUT does not spin, and does not run more commands.
+  unsigned long startMillis = millis();
+  server.process(50);
+  assertMore(millis() - startMillis, 40UL);
+  assertEqual(fillCommand.mNumRuns, numRuns);
+
+  // The client reads its output, so the rest of the commands are run.
+  uint32_t numReceived = 0;
+  for (uint16_t pass = 0; pass < 10000; pass++) {
+    char response[1024];
+    ssize_t n = recv(fds[1], response, sizeof(response), MSG_DONTWAIT);
+    if (n > 0) numReceived += n;
+    server.process();
+    if (fillCommand.mNumRuns == kNumLines
+        && numReceived + server.getNumDroppedBytes()
+            == (uint32_t) kNumLines * 1000) {
+      break;
+    }
+  }
+  assertEqual(fillCommand.mNumRuns, kNumLines);
+  assertEqual(numReceived + server.getNumDroppedBytes(),
+      (uint32_t) kNumLines * 1000);
+
+  server.close();
+  close(fds[1]);
+}
+
+// A client which finds no free line buffer must not keep the epoll_wait()
+// from blocking, and is served when a line buffer is released.
+test(FdServer_starvedClientWaits) {
+  FdServer<BUF_SIZE, ARGV_SIZE, 1, 2> server(ARGS_COMMANDS, 2);
+
+  int fdsA[2];
+  int fdsB[2];
+  assertEqual(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fdsA), 0);
+  assertEqual(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fdsB), 0);
+  assertTrue(server.addClient(fdsA[0]));
+  assertTrue(server.addClient(fdsB[0]));
+
+  // Client A holds the only line buffer with its partial line.
+  assertEqual(write(fdsA[1], "args a", 6), (ssize_t) 6);
+  server.process();
+  assertEqual(server.getBufferPool().getNumFree(), 0);
+
+  assertEqual(write(fdsB[1], "args b\n", 7), (ssize_t) 7);
+  server.process();
+  assertEqual(server.getNumStarved(), (uint16_t) 1);
+
+  unsigned long startMillis = millis();
+  server.process(50);
+  assertMore(millis() - startMillis, 40UL);
+
+  // Client A completes its line and releases the buffer to client B.
+  assertEqual(write(fdsA[1], "\n", 1), (ssize_t) 1);
+  server.process(50);
+  server.process(50);
+  assertEqual(server.getNumStarved(), (uint16_t) 0);
+  assertEqual(server.getBufferPool().getNumFree(), 1);
+
+  char response[16];
+  ssize_t n = recv(fdsA[1], response, sizeof(response) - 1, MSG_DONTWAIT);
+  assertMore(n, (ssize_t) 0);
+  response[n] = '\0';
+  assertEqual(response, "[args][a]");
+  n = recv(fdsB[1], response, sizeof(response) - 1, MSG_DONTWAIT);
+  assertMore(n, (ssize_t) 0);
+  response[n] = '\0';
+  assertEqual(response, "[args][b]");
+
+  server.close();
+  close(fdsA[1]);
+  close(fdsB[1]);
+}
+
+#endif
+
+//---------------------------------------------------------------------------
+
+void setup() {
+#if defined(ARDUINO)
+  delay(1000); // some boards reboot twice
+#endif
+  Serial.begin(115200);
+  while (!Serial); // Leonardo/Micro
+}
+
+void loop() {
+  TestRunner::run();
+}
@@ -0,0 +1,178 @@
+#line 2 "CliStatsTest.ino"
+
+/*
+ * Tests of the execution statistics of the cli/ library. The
+ * ACE_UTILS_CLI_ENABLE_STATS macro changes the size of CommandHandler, so it
+ * must be defined for all translation units by the Makefile, instead of being
+ * defined in this file. Without it, no tests are compiled.
+ */
+
+#include <Arduino.h> // Print
+#include <AceCommon.h> // PrintStr
+#include <AUnitVerbose.h>
+#include <AceUtils.h>
+#include <cli/cli.h> // from AceUtils.h
+
+using aunit::TestRunner;
+using ace_utils::cli::CommandHandler;
+using ace_utils::cli::CommandDispatcher;
+using ace_utils::cli::DirectProcessor;
+using ace_common::PrintStr;
+
+#if ACE_UTILS_CLI_ENABLE_STATS
+
+using ace_utils::cli::CommandStats;
+
+// A command that prints "hello".
+class HelloCommand: public CommandHandler {
+  public:
+    HelloCommand(): CommandHandler("hello", nullptr) {}
+
+    void run(Print& printer, int /*argc*/, const char* const* /*argv*/)
+        const override {
+      printer.print("hello");
+    }
+};
+
+static HelloCommand helloCommand;
+
+static const CommandHandler* const COMMANDS[] = {
+  &helloCommand,
+};
+
+static const uint8_t ARGV_SIZE = 4;
+static const uint8_t BUF_SIZE = 8;
+
+test(recordRun) {
+  PrintStr<64> printer;
+  const char* argv[ARGV_SIZE];
+  CommandDispatcher dispatcher(COMMANDS, 1, argv, ARGV_SIZE);
+
+  char line1[] = "hello";
+  char line2[] = "hello";
+  char line3[] = "bye";
+  dispatcher.runCommand(printer, line1);
+  dispatcher.runCommand(printer, line2);
+  dispatcher.runCommand(printer, line3);
+
+  const CommandStats& stats = helloCommand.getStats();
+  assertEqual(stats.count, 2);
+  assertEqual(stats.bytesWritten, (uint32_t) 10);
+  assertMoreOrEqual(stats.totalMicros, stats.maxMicros);
+  assertEqual(dispatcher.getNumUnknownCommands(), 1);
+}
+
+// A Stream which returns the given string.
+class StringStream: public Stream {
+  public:
+    explicit StringStream(const char* s): mString(s) {}
+
+    int available() override { return strlen(mString); }
+
+    int read() override {
+      return (*mString == '\0') ? -1 : *mString++;
+    }
+
+    int peek() override {
+      return (*mString == '\0') ? -1 : *mString;
+    }
+
+    size_t write(uint8_t) override { return 0; }
+
+  private:
+    const char* mString;
+};
+
+test(recordOverflow) {
+  StringStream stream("hellohello\nhello\n");
+  PrintStr<128> printer;
+  const char* argv[ARGV_SIZE];
+  CommandDispatcher dispatcher(COMMANDS, 1, argv, ARGV_SIZE);
+  char buf[BUF_SIZE];
+  DirectProcessor processor(stream, dispatcher, printer, buf, BUF_SIZE);
+
+  processor.process();
+  assertEqual(dispatcher.getNumOverflows(), 1);
+}
+
+// A long-running command which prints one '.' per poll(), and receives a
+// payload which it echoes.
+class SlowCommand: public CommandHandler {
+  public:
+    SlowCommand(): CommandHandler("slow", nullptr) {}
+
+    void run(Print& printer, int /*argc*/, const char* const* /*argv*/)
+        const override {
+      printer.print('<');
+      mPolls = 0;
+    }
+
+    uint32_t getPayloadSize() const override { return 3; }
+
+    void receivePayload(Print& printer, const char* data, uint8_t len)
+        const override {
+      printer.write((const uint8_t*) data, len);
+    }
+
+    bool poll(Print& printer) const override {
+      printer.print('.');
+      return ++mPolls >= 2;
+    }
+
+  private:
+    mutable uint8_t mPolls = 0;
+};
+
+static SlowCommand slowCommand;
+
+static const CommandHandler* const SLOW_COMMANDS[] = {
+  &slowCommand,
+};
+
+// The bytes written by poll() and receivePayload() are recorded too.
+test(recordPollAndPayload) {
+  StringStream stream("slow\nabc");
+  PrintStr<64> printer;
+  const char* argv[ARGV_SIZE];
+  CommandDispatcher dispatcher(SLOW_COMMANDS, 1, argv, ARGV_SIZE);
+  char buf[BUF_SIZE];
+  DirectProcessor processor(stream, dispatcher, printer, buf, BUF_SIZE);
+
+  processor.process();
+  processor.process();
+  assertEqual(printer.getCstr(), "<abc..");
+
+  const CommandStats& stats = slowCommand.getStats();
+  assertEqual(stats.count, 1);
+  assertEqual(stats.bytesWritten, (uint32_t) 6);
+  assertMoreOrEqual(stats.totalMicros, stats.maxMicros);
+}
+
+test(statsCommand) {
+  PrintStr<128> printer;
+  const char* argv[ARGV_SIZE];
+  CommandDispatcher dispatcher(COMMANDS, 1, argv, ARGV_SIZE);
+
+  char line[] = "stats";
+  dispatcher.runCommand(printer, line);
+  const char* output = printer.getCstr();
+  const char prefix[] = "Commands:\r\n  hello: count=";
+  assertTrue(strncmp(output, prefix, sizeof(prefix) - 1) == 0);
+  assertTrue(strstr(output, "Unknown: 0\r\nOverflows: 0\r\n") != nullptr);
+}
+
+#endif
+
+//---------------------------------------------------------------------------
+
+void setup() {
+#if defined(ARDUINO)
+  delay(1000); // some boards reboot twice
+#endif
+  Serial.begin(115200);
+  while (!Serial); // Leonardo/Micro
+}
+
+void loop() {
+  TestRunner::run();
+}
@@ -5,6 +5,7 @@
 #include <AUnitVerbose.h>
 #include <AceUtils.h>
 #include <cli/cli.h> // from AceUtils.h
+#include <cli/FrameProcessorManager.h> // from AceUtils.h
 
 using aunit::TestRunner;
 using aunit::TestOnce;
@@ -12,7 +13,40 @@ using ace_utils::cli::CommandHandler;
 using ace_utils::cli::CommandDispatcher;
 using ace_utils::cli::ChannelProcessorCoroutine;
 using ace_utils::cli::ChannelProcessorManager;
+using ace_utils::cli::TokenSpan;
+using ace_utils::cli::LineReader;
+using ace_utils::cli::DirectProcessor;
+using ace_utils::cli::SessionProcessor;
+using ace_utils::cli::SessionProcessorManager;
+using ace_utils::cli::QueueProcessorManager;
+using ace_utils::cli::BufferedPrint;
+using ace_utils::cli::BinaryFrame;
+using ace_utils::cli::FrameProcessorManager;
+using ace_utils::cli::StreamProcessorCoroutine;
+using ace_utils::cli::LoopJitter;
+using ace_utils::cli::JitterCommand;
+using ace_utils::cli::EventLog;
+using ace_utils::cli::FixedEventLog;
+using ace_utils::cli::EventLogCommand;
+using ace_utils::cli::StaticProcessorManager;
+using ace_utils::cli::ProgmemCommand;
+using ace_utils::cli::BoundCommand;
+using ace_utils::cli::FlowControl;
+using ace_utils::cli::XonXoffFlowControl;
+using ace_utils::cli::ArgSpec;
+using ace_utils::cli::ArgValue;
+using ace_utils::cli::ArgSchema;
+using ace_utils::cli::SchemaCommandHandler;
+using ace_utils::cli::DirectProcessorManager;
+using ace_utils::cli::WatchCoroutine;
+using ace_utils::cli::WatchManager;
+using ace_utils::cli::FixedRingBufferStream;
+using ace_utils::cli::ScratchArena;
+using ace_utils::cli::FixedScratchArena;
+using ace_utils::cli::ArenaCommandHandler;
+using ace_utils::cli::NumberFormat;
 using ace_common::FCString;
+using ace_common::PrintStr;
 
 // ---------------------------------------------------------------------------
 
@@ -83,6 +117,149 @@ testF(CommandDispatcherTest, tokenize) {
   assertArgvEquals(argv, expected, count);
 }
 
+testF(CommandDispatcherTest, tokenize_inPlace) {
+  const char* expected[] = { "a", "bb", "c" };
+  const char* argv[ARGV_SIZE];
+
+  // Multiple and mixed delimiters, with leading and trailing whitespace.
+  char LINE[] = " \ta  bb\tc \n";
+  uint8_t count = CommandDispatcher::tokenize(LINE, argv, ARGV_SIZE);
+  assertEqual(count, 3);
+  assertArgvEquals(argv, expected, count);
+}
+
+test(tokenizeSpans) {
+  TokenSpan spans[ARGV_SIZE];
+
+  const char BLANK[] = " \t\n";
+  uint8_t count = CommandDispatcher::tokenizeSpans(BLANK, spans, ARGV_SIZE);
+  assertEqual(count, 0);
+
+  const char LINE[] = " ab  c\tdef\n";
+  count = CommandDispatcher::tokenizeSpans(LINE, spans, ARGV_SIZE);
+  assertEqual(count, 3);
+  assertEqual(spans[0].offset, 1);
+  assertEqual(spans[0].length, 2);
+  assertEqual(spans[1].offset, 5);
+  assertEqual(spans[1].length, 1);
+  assertEqual(spans[2].offset, 7);
+  assertEqual(spans[2].length, 3);
+
+  // Truncated to spansSize.
+  const char LINE5[] = "a b c d e";
+  count = CommandDispatcher::tokenizeSpans(LINE5, spans, ARGV_SIZE);
+  assertEqual(count, ARGV_SIZE);
+  assertEqual(spans[3].offset, 6);
+}
+
+testF(CommandDispatcherTest, terminateTokens) {
+  const char* expected[] = { "a", "b", "c", "d" };
+  const char* argv[ARGV_SIZE];
+
+  char LINE[] = "a\tb c\vd e\n";
+  uint8_t count = CommandDispatcher::terminateTokens(LINE, argv, ARGV_SIZE);
+  assertEqual(count, 4);
+  assertArgvEquals(argv, expected, count);
+  assertEqual(argv[0], LINE);
+}
+
+testF(CommandDispatcherTest, copyTokens) {
+  const char* expected[] = { "a", "bb", "c", "d" };
+  const char* argv[ARGV_SIZE];
+  char tokens[BUF_SIZE];
+
+  const char LINE[] = " a\tbb c\vd e\n";
+  uint8_t count = CommandDispatcher::copyTokens(
+      LINE, argv, ARGV_SIZE, tokens, sizeof(tokens));
+  assertEqual(count, 4);
+  assertArgvEquals(argv, expected, count);
+  assertEqual(LINE, " a\tbb c\vd e\n");
+
+  // The tokens which do not fit into the buffer are dropped.
+  count = CommandDispatcher::copyTokens(LINE, argv, ARGV_SIZE, tokens, 5);
+  assertEqual(count, 2);
+  assertArgvEquals(argv, expected, count);
+}
+
+/** Print each argv token, surrounded by brackets. */
+class ArgsCommand: public CommandHandler {
+  public:
+    ArgsCommand(): CommandHandler("args", nullptr) {}
+
+    void run(Print& printer, int argc, const char* const* argv)
+        const override {
+      for (int i = 0; i < argc; i++) {
+        printer.print('[');
+        printer.print(argv[i]);
+        printer.print(']');
+      }
+    }
+};
+
+static ArgsCommand argsCommand;
+static const CommandHandler* const ARGS_COMMANDS[] = {
+  &argsCommand,
+};
+
+test(runCommand_keepsLine) {
+  const char* argv[ARGV_SIZE];
+  char tokens[BUF_SIZE];
+  CommandDispatcher dispatcher(
+      ARGS_COMMANDS, 1, argv, ARGV_SIZE, nullptr, tokens, BUF_SIZE);
+  PrintStr<64> printer;
+
+  char LINE[] = "args  x\ty\n";
+  dispatcher.runCommand(printer, LINE);
+  assertEqual(printer.getCstr(), "[args][x][y]");
+  assertEqual(LINE, "args  x\ty\n");
+
+  // Dispatch the same line again.
+  printer.flush();
+  dispatcher.runCommand(printer, LINE);
+  assertEqual(printer.getCstr(), "[args][x][y]");
+}
+
+/**
+ * Run the line 'args inner' on the same dispatcher, then print its own argv,
+ * which must not be clobbered by the nested command.
+ */
+class NestCommand: public CommandHandler {
+  public:
+    NestCommand(): CommandHandler("nest", nullptr) {}
+
+    void run(Print& printer, int argc, const char* const* argv)
+        const override {
+      char line[] = "args inner";
+      mDispatcher->runCommand(printer, line);
+      for (int i = 0; i < argc; i++) {
+        printer.print('<');
+        printer.print(argv[i]);
+        printer.print('>');
+      }
+    }
+
+    const CommandDispatcher* mDispatcher = nullptr;
+};
+
+test(runCommand_nested) {
+  static NestCommand nestCommand;
+  static const CommandHandler* const NEST_COMMANDS[] = {
+    &argsCommand,
+    &nestCommand,
+  };
+  const char* argv[ARGV_SIZE];
+  char tokens[BUF_SIZE];
+  CommandDispatcher dispatcher(
+      NEST_COMMANDS, 2, argv, ARGV_SIZE, nullptr, tokens, BUF_SIZE);
+  nestCommand.mDispatcher = &dispatcher;
+  PrintStr<64> printer;
+
+  char LINE[] = "nest a";
+  dispatcher.runCommand(printer, LINE);
+  assertEqual(printer.getCstr(), "[args][inner]<nest><a>");
+  assertEqual(LINE, "nest a");
+}
+
 test(findCommand) {
   const ChannelProcessorCoroutine& channelProcessor =
       commandManager.getChannelProcessor();
@@ -109,6 +286,1643 @@ test(findCommand) {
   assertEqual(notFound, nullptr);
 }
 
+// Same commands as COMMANDS, but sorted by name.
+static const CommandHandler* const SORTED_COMMANDS[] = {
+  &echoCommand,
+  &listCommand,
+  &lsCommand,
+};
+
+test(findCommand_sortedCommands) {
+  const char* argv[ARGV_SIZE];
+  CommandDispatcher dispatcher(SORTED_COMMANDS, NUM_COMMANDS, argv, ARGV_SIZE);
+  assertTrue(dispatcher.isBinarySearch());
+
+  assertEqual(dispatcher.findCommand("echo"), &echoCommand);
+  assertEqual(dispatcher.findCommand("list"), &listCommand);
+  assertEqual(dispatcher.findCommand("ls"), &lsCommand);
+  assertEqual(dispatcher.findCommand("a"), nullptr);
+  assertEqual(dispatcher.findCommand("lt"), nullptr);
+  assertEqual(dispatcher.findCommand("z"), nullptr);
+}
+
+test(findCommand_sortedIndex) {
+  const char* argv[ARGV_SIZE];
+  uint8_t sortedIndex[NUM_COMMANDS];
+  CommandDispatcher dispatcher(
+      COMMANDS, NUM_COMMANDS, argv, ARGV_SIZE, sortedIndex);
+  assertTrue(dispatcher.isBinarySearch());
+
+  // COMMANDS is {echo, ls, list}, so sorted order is {echo, list, ls}.
+  assertEqual(sortedIndex[0], 0);
+  assertEqual(sortedIndex[1], 2);
+  assertEqual(sortedIndex[2], 1);
+
+  assertEqual(dispatcher.findCommand("echo"), &echoCommand);
+  assertEqual(dispatcher.findCommand("list"), &listCommand);
+  assertEqual(dispatcher.findCommand("ls"), &lsCommand);
+  assertEqual(dispatcher.findCommand("NOTFOUND"), nullptr);
+}
+
+test(findCommand_unsortedLinear) {
+  const char* argv[ARGV_SIZE];
+  CommandDispatcher dispatcher(COMMANDS, NUM_COMMANDS, argv, ARGV_SIZE);
+  assertFalse(dispatcher.isBinarySearch());
+  assertEqual(dispatcher.findCommand("list"), &listCommand);
+  assertEqual(dispatcher.findCommand("NOTFOUND"), nullptr);
+}
+
+// ---------------------------------------------------------------------------
+
+/**
+ * A Stream that reads from a fixed string, returning at most 'chunk' bytes
+ * from available() to simulate bytes arriving over a serial port.
+ */
+class TestStream: public Stream {
+  public:
+    void set(const char* s, size_t chunk = 1000) {
+      setBytes(s, strlen(s), chunk);
+    }
+
+    void setBytes(const char* s, size_t len, size_t chunk = 1000) {
+      mString = s;
+      mLen = len;
+      mPos = 0;
+      mChunk = chunk;
+      mAvailable = 0;
+    }
+
+    /** Make the next chunk of bytes available. */
+    void arrive() {
+      size_t remaining = mLen - mPos;
+      mAvailable = (remaining < mChunk) ? remaining : mChunk;
+    }
+
+    int available() override { return mAvailable; }
+
+    int read() override {
+      if (mAvailable == 0) return -1;
+      mAvailable--;
+      return mString[mPos++];
+    }
+
+    int peek() override {
+      return (mAvailable == 0) ? -1 : mString[mPos];
+    }
+
+    size_t write(uint8_t) override { return 0; }
+
+  private:
+    const char* mString = "";
+    size_t mLen = 0;
+    size_t mPos = 0;
+    size_t mChunk = 0;
+    size_t mAvailable = 0;
+};
+
+test(LineReader_multipleLines) {
+  TestStream stream;
+  char buf[16];
+  LineReader reader(buf, sizeof(buf));
+
+  stream.set("ab\ncd\r\nef");
+  stream.arrive();
+  assertEqual(reader.next(), LineReader::kStatusNone);
+  assertEqual(reader.fill(stream), 9);
+
+  assertEqual(reader.next(), LineReader::kStatusLine);
+  assertEqual(reader.getLine(), "ab");
+  assertEqual(reader.next(), LineReader::kStatusLine);
+  assertEqual(reader.getLine(), "cd");
+  assertEqual(reader.next(), LineReader::kStatusLine);
+  assertEqual(reader.getLine(), "");
+  assertEqual(reader.next(), LineReader::kStatusNone);
+  assertTrue(reader.hasPending());
+  assertEqual(reader.fill(stream), 0);
+}
+
+test(LineReader_partialLines) {
+  TestStream stream;
+  char buf[8];
+  LineReader reader(buf, sizeof(buf));
+
+  stream.set("abc\ndefg\n", 3);
+  stream.arrive();
+  assertEqual(reader.fill(stream), 3);
+  assertEqual(reader.next(), LineReader::kStatusNone);
+  stream.arrive();
+  assertEqual(reader.fill(stream), 3);
+  assertEqual(reader.next(), LineReader::kStatusLine);
+  assertEqual(reader.getLine(), "abc");
+  assertEqual(reader.next(), LineReader::kStatusNone);
+  stream.arrive();
+  assertEqual(reader.fill(stream), 3);
+  assertEqual(reader.next(), LineReader::kStatusLine);
+  assertEqual(reader.getLine(), "defg");
+  assertFalse(reader.hasPending());
+}
+
+test(LineReader_overflow) {
+  TestStream stream;
+  char buf[4];
+  LineReader reader(buf, sizeof(buf));
+
+  // Longest line is 3 characters.
+  stream.set("abc\nabcdefghij\nxy\n");
+  stream.arrive();
+  assertEqual(reader.fill(stream), 4);
+  assertEqual(reader.next(), LineReader::kStatusLine);
+  assertEqual(reader.getLine(), "abc");
+
+  assertEqual(reader.fill(stream), 4);
+  assertEqual(reader.next(), LineReader::kStatusOverflow);
+  assertEqual(reader.fill(stream), 4);
+  assertEqual(reader.next(), LineReader::kStatusNone);
+  assertEqual(reader.fill(stream), 4);
+  assertEqual(reader.next(), LineReader::kStatusFlushed);
+  assertEqual(reader.fill(stream), 2);
+  assertEqual(reader.next(), LineReader::kStatusLine);
+  assertEqual(reader.getLine(), "xy");
+}
+
+test(LineReader_setBufferClearsFlushing) {
+  TestStream stream;
+  char buf[4];
+  char other[4];
+  LineReader reader(buf, sizeof(buf));
+
+  // Overflow the buffer, then replace it while the line is being flushed.
+  stream.set("abcdef\nxy\n");
+  stream.arrive();
+  assertEqual(reader.fill(stream), 4);
+  assertEqual(reader.next(), LineReader::kStatusOverflow);
+  assertFalse(reader.isIdle());
+  reader.setBuffer(other, sizeof(other));
+  assertTrue(reader.isIdle());
+
+  // The next line is a new line, not the tail of the overflowed one.
+  stream.set("xy\n");
+  stream.arrive();
+  assertEqual(reader.fill(stream), 3);
+  assertEqual(reader.next(), LineReader::kStatusLine);
+  assertEqual(reader.getLine(), "xy");
+}
+
+test(DirectProcessor_pipelinedCommands) {
+  TestStream stream;
+  PrintStr<64> printer;
+  const char* argv[ARGV_SIZE];
+  char tokens[BUF_SIZE];
+  CommandDispatcher dispatcher(
+      ARGS_COMMANDS, 1, argv, ARGV_SIZE, nullptr, tokens, BUF_SIZE);
+  char buf[BUF_SIZE];
+  DirectProcessor processor(stream, dispatcher, printer, buf, BUF_SIZE);
+
+  stream.set("args a\nargs b c\nargs", 5);
+  for (uint8_t i = 0; i < 5; i++) {
+    stream.arrive();
+    processor.process();
+  }
+  assertEqual(printer.getCstr(), "[args][a][args][b][c]");
+}
+
+// A long-running command which prints a countdown, one number per poll().
+class CountdownCommand: public CommandHandler {
+  public:
+    CountdownCommand(): CommandHandler("countdown", "n") {}
+
+    void run(Print& /*printer*/, int argc, const char* const* argv)
+        const override {
+      mRemaining = (argc > 1) ? atoi(argv[1]) : 0;
+    }
+
+    bool poll(Print& printer) const override {
+      if (mRemaining == 0) return true;
+      printer.print(mRemaining);
+      mRemaining--;
+      return mRemaining == 0;
+    }
+
+  private:
+    mutable int mRemaining = 0;
+};
+
+static CountdownCommand countdownCommand;
+static const CommandHandler* const ASYNC_COMMANDS[] = {
+  &argsCommand,
+  &countdownCommand,
+};
+
+test(DirectProcessor_longRunningCommand) {
+  TestStream stream;
+  PrintStr<64> printer;
+  const char* argv[ARGV_SIZE];
+  CommandDispatcher dispatcher(ASYNC_COMMANDS, 2, argv, ARGV_SIZE);
+  char buf[BUF_SIZE];
+  DirectProcessor processor(stream, dispatcher, printer, buf, BUF_SIZE);
+
+  // The following line is held until the countdown finishes.
+  stream.set("countdown 3\nargs x\n");
+  stream.arrive();
+  processor.process();
+  assertEqual(printer.getCstr(), "3");
+  processor.process();
+  assertEqual(printer.getCstr(), "32");
+  processor.process();
+  assertEqual(printer.getCstr(), "321[args][x]");
+}
+
+/** Copy a payload of 'n' bytes into a buffer, print it when complete. */
+class LoadCommand: public CommandHandler {
+  public:
+    LoadCommand(): CommandHandler("load", "n") {}
+
+    void run(Print& /*printer*/, int argc, const char* const* argv)
+        const override {
+      mSize = (argc > 1) ? atoi(argv[1]) : 0;
+      mLen = 0;
+      mNumChunks = 0;
+    }
+
+    uint32_t getPayloadSize() const override { return mSize; }
+
+    void receivePayload(Print& /*printer*/, const char* data, uint8_t len)
+        const override {
+      memcpy(mData + mLen, data, len);
+      mLen += len;
+      mNumChunks++;
+    }
+
+    bool poll(Print& printer) const override {
+      mData[mLen] = '\0';
+      printer.print('<');
+      printer.print(mData);
+      printer.print('>');
+      return true;
+    }
+
+    mutable uint8_t mNumChunks = 0;
+
+  private:
+    mutable char mData[32];
+    mutable uint8_t mSize = 0;
+    mutable uint8_t mLen = 0;
+};
+
+static LoadCommand loadCommand;
+static const CommandHandler* const PAYLOAD_COMMANDS[] = {
+  &argsCommand,
+  &loadCommand,
+};
+
+test(DirectProcessor_payload) {
+  TestStream stream;
+  PrintStr<64> printer;
+  const char* argv[ARGV_SIZE];
+  CommandDispatcher dispatcher(PAYLOAD_COMMANDS, 2, argv, ARGV_SIZE);
+  char buf[BUF_SIZE];
+  DirectProcessor processor(stream, dispatcher, printer, buf, BUF_SIZE);
+
+  // The payload may contain newlines, and arrives in chunks.
+  stream.set("load 10\n01234\n6789args x\n", 6);
+  for (uint8_t i = 0; i < 5; i++) {
+    stream.arrive();
+    processor.process();
+  }
+  assertEqual(printer.getCstr(), "<01234\n6789>[args][x]");
+  assertMore(loadCommand.mNumChunks, (uint8_t) 1);
+}
+
+// The budget is checked between the chunks of a payload.
+test(DirectProcessor_payloadBudget) {
+  TestStream stream;
+  PrintStr<64> printer;
+  const char* argv[ARGV_SIZE];
+  CommandDispatcher dispatcher(PAYLOAD_COMMANDS, 2, argv, ARGV_SIZE);
+  char buf[16];
+  DirectProcessor processor(stream, dispatcher, printer, buf, sizeof(buf));
+
+  // The 16-byte line buffer holds the command line and the first 8 bytes.
+  processor.setBudget(0, 1, 0);
+  stream.set("load 24\nabcdefghijklmnopqrstuvwx");
+  stream.arrive();
+  processor.process();
+  assertEqual(loadCommand.mNumChunks, (uint8_t) 1);
+  assertEqual(processor.getNumBudgetHits(), (uint16_t) 1);
+  assertEqual(printer.getCstr(), "");
+
+  processor.process();
+  assertEqual(printer.getCstr(), "<abcdefghijklmnopqrstuvwx>");
+}
+
+test(StreamProcessorCoroutine_payload) {
+  TestStream stream;
+  PrintStr<64> printer;
+  const char* argv[ARGV_SIZE];
+  CommandDispatcher dispatcher(PAYLOAD_COMMANDS, 2, argv, ARGV_SIZE);
+  char buf[BUF_SIZE];
+  StreamProcessorCoroutine processor(
+      stream, dispatcher, printer, buf, BUF_SIZE);
+
+  stream.set("load 3\nabcargs y\n");
+  stream.arrive();
+  processor.runCoroutine();
+  processor.runCoroutine();
+  assertEqual(printer.getCstr(), "<abc>[args][y]");
+}
+
+test(DirectProcessor_flowControl) {
+  TestStream stream;
+  PrintStr<64> printer;
+  PrintStr<8> host;
+  XonXoffFlowControl flowControl(host, 16, 0);
+  const char* argv[ARGV_SIZE];
+  CommandDispatcher dispatcher(ASYNC_COMMANDS, 2, argv, ARGV_SIZE);
+  char buf[BUF_SIZE];
+  DirectProcessor processor(stream, dispatcher, printer, buf, BUF_SIZE);
+  processor.setFlowControl(&flowControl);
+
+  // XOFF while the long-running command holds the input, then XON.
+  stream.set("countdown 2\nargs x\n");
+  stream.arrive();
+  processor.process();
+  assertEqual(printer.getCstr(), "2");
+  assertEqual(host.getCstr(), "\x13");
+  assertTrue(flowControl.isPaused());
+  processor.process();
+  assertEqual(printer.getCstr(), "21[args][x]");
+  assertEqual(host.getCstr(), "\x13\x11");
+  assertFalse(flowControl.isPaused());
+  assertEqual(flowControl.getNumPauses(), (uint16_t) 1);
+}
+
+// The host stays stopped while the budget leaves lines in the line buffer.
+test(DirectProcessor_flowControlBudget) {
+  TestStream stream;
+  PrintStr<64> printer;
+  PrintStr<8> host;
+  XonXoffFlowControl flowControl(host, 16, 0);
+  const char* argv[ARGV_SIZE];
+  CommandDispatcher dispatcher(ARGS_COMMANDS, 1, argv, ARGV_SIZE);
+  char buf[BUF_SIZE];
+  DirectProcessor processor(stream, dispatcher, printer, buf, BUF_SIZE);
+  processor.setFlowControl(&flowControl);
+  processor.setBudget(0, 1, 0);
+
+  stream.set("args a\nargs b\n");
+  stream.arrive();
+  processor.process();
+  assertEqual(printer.getCstr(), "[args][a]");
+  assertEqual(stream.available(), 0);
+  assertTrue(flowControl.isPaused());
+
+  processor.process();
+  assertEqual(printer.getCstr(), "[args][a][args][b]");
+  assertFalse(flowControl.isPaused());
+  assertEqual(host.getCstr(), "\x13\x11");
+}
+
+/**
+ * A slow command, during which more input arrives on 'slowStream'. Records
+ * whether the host had been told to stop before it ran.
+ */
+class SlowCommand: public CommandHandler {
+  public:
+    SlowCommand(): CommandHandler("slow", nullptr) {}
+
+    void run(Print& printer, int /*argc*/, const char* const* /*argv*/)
+        const override {
+      pausedDuringRun = flowControl->isPaused();
+      stream->arrive();
+      printer.print("<slow>");
+    }
+
+    TestStream* stream;
+    const FlowControl* flowControl;
+    mutable bool pausedDuringRun;
+};
+
+static SlowCommand slowCommand;
+static const CommandHandler* const SLOW_COMMANDS[] = {
+  &argsCommand,
+  &slowCommand,
+};
+
+test(DirectProcessor_flowControlBeforeSlowCommand) {
+  TestStream stream;
+  PrintStr<64> printer;
+  PrintStr<8> host;
+  XonXoffFlowControl flowControl(host, 16, 0);
+  const char* argv[ARGV_SIZE];
+  CommandDispatcher dispatcher(SLOW_COMMANDS, 2, argv, ARGV_SIZE);
+  char buf[BUF_SIZE];
+  DirectProcessor processor(stream, dispatcher, printer, buf, BUF_SIZE);
+  processor.setFlowControl(&flowControl);
+  slowCommand.stream = &stream;
+  slowCommand.flowControl = &flowControl;
+  slowCommand.pausedDuringRun = false;
+
+  // The input arrives 8 bytes at a time. The next line is already waiting
+  // in the line buffer when the slow command runs, so XOFF is sent first.
+  stream.set("slow\nargs a\nargs b\n", 8);
+  stream.arrive();
+  processor.process();
+  assertTrue(slowCommand.pausedDuringRun);
+  assertEqual(printer.getCstr(), "<slow>[args][a]");
+  assertEqual(host.getCstr(), "\x13\x11");
+
+  stream.arrive();
+  processor.process();
+  assertEqual(printer.getCstr(), "<slow>[args][a][args][b]");
+  assertFalse(flowControl.isPaused());
+}
+
+test(StreamProcessorCoroutine_flowControlBeforeSlowCommand) {
+  TestStream stream;
+  PrintStr<64> printer;
+  PrintStr<8> host;
+  XonXoffFlowControl flowControl(host, 16, 0);
+  const char* argv[ARGV_SIZE];
+  CommandDispatcher dispatcher(SLOW_COMMANDS, 2, argv, ARGV_SIZE);
+  char buf[BUF_SIZE];
+  StreamProcessorCoroutine processor(
+      stream, dispatcher, printer, buf, BUF_SIZE);
+  processor.setFlowControl(&flowControl);
+  slowCommand.stream = &stream;
+  slowCommand.flowControl = &flowControl;
+  slowCommand.pausedDuringRun = false;
+
+  stream.set("slow\nargs a\nargs b\n", 8);
+  stream.arrive();
+  processor.runCoroutine();
+  assertTrue(slowCommand.pausedDuringRun);
+  assertEqual(printer.getCstr(), "<slow>[args][a]");
+  assertEqual(host.getCstr(), "\x13\x11");
+}
+
+class TestFlowControl: public FlowControl {
+  public:
+    TestFlowControl(): FlowControl(16, 4) {}
+    uint8_t numChanges = 0;
+
+  protected:
+    void setReady(bool /*ready*/) override { numChanges++; }
+};
+
+test(FlowControl_watermarks) {
+  TestFlowControl flowControl;
+  flowControl.update(10, false);
+  assertFalse(flowControl.isPaused());
+  flowControl.update(16, false);
+  assertTrue(flowControl.isPaused());
+  flowControl.update(10, false);
+  assertTrue(flowControl.isPaused());
+  flowControl.update(4, false);
+  assertFalse(flowControl.isPaused());
+  assertEqual(flowControl.numChanges, (uint8_t) 2);
+
+  // Pause while the output ring is nearly full.
+  PrintStr<8> device;
+  char ring[8];
+  BufferedPrint output(device, ring, sizeof(ring));
+  flowControl.setOutput(&output, 6);
+  output.print("abcdef");
+  flowControl.update(0, false);
+  assertTrue(flowControl.isPaused());
+  output.drainAll();
+  flowControl.update(0, false);
+  assertFalse(flowControl.isPaused());
+}
+
+test(StreamProcessorCoroutine_wakeup) {
+  TestStream stream;
+  PrintStr<64> printer;
+  const char* argv[ARGV_SIZE];
+  CommandDispatcher dispatcher(ARGS_COMMANDS, 1, argv, ARGV_SIZE);
+  char buf[BUF_SIZE];
+  StreamProcessorCoroutine processor(
+      stream, dispatcher, printer, buf, BUF_SIZE);
+  processor.setWakeupEnabled(true);
+
+  // No input, so the coroutine suspends itself.
+  stream.set("");
+  processor.runCoroutine();
+  assertTrue(processor.isSuspended());
+
+  // Data arrives, and the callback wakes up the coroutine.
+  stream.set("args a\n");
+  stream.arrive();
+  processor.wakeup();
+  assertFalse(processor.isSuspended());
+  processor.runCoroutine();
+  assertEqual(printer.getCstr(), "[args][a]");
+  assertTrue(processor.isSuspended());
+
+  // Data which arrives without a wakeup() before the coroutine suspends
+  // itself keeps it runnable.
+  printer.flush();
+  stream.set("args b\nargs c\n");
+  stream.arrive();
+  processor.setBudget(0, 1, 0);
+  processor.wakeup();
+  processor.runCoroutine();
+  processor.runCoroutine();
+  assertEqual(printer.getCstr(), "[args][b][args][c]");
+  assertTrue(processor.isSuspended());
+
+  processor.setWakeupEnabled(false);
+  assertFalse(processor.isSuspended());
+}
+
+test(StreamProcessorCoroutine_longRunningCommand) {
+  TestStream stream;
+  PrintStr<64> printer;
+  const char* argv[ARGV_SIZE];
+  CommandDispatcher dispatcher(ASYNC_COMMANDS, 2, argv, ARGV_SIZE);
+  char buf[BUF_SIZE];
+  StreamProcessorCoroutine processor(
+      stream, dispatcher, printer, buf, BUF_SIZE);
+
+  stream.set("countdown 2\nargs y\n");
+  stream.arrive();
+  processor.runCoroutine();
+  assertEqual(printer.getCstr(), "2");
+  processor.runCoroutine();
+  assertEqual(printer.getCstr(), "21[args][y]");
+}
+
+test(DirectProcessor_budget) {
+  TestStream stream;
+  PrintStr<64> printer;
+  const char* argv[ARGV_SIZE];
+  CommandDispatcher dispatcher(ARGS_COMMANDS, 1, argv, ARGV_SIZE);
+  char buf[BUF_SIZE];
+  DirectProcessor processor(stream, dispatcher, printer, buf, BUF_SIZE);
+
+  // One command per call.
+  processor.setBudget(0, 1, 0);
+  stream.set("args a\nargs b\n");
+  stream.arrive();
+  processor.process();
+  assertEqual(printer.getCstr(), "[args][a]");
+  assertEqual(processor.getNumBudgetHits(), (uint16_t) 1);
+  processor.process();
+  assertEqual(printer.getCstr(), "[args][a][args][b]");
+  assertEqual(processor.getNumBudgetHits(), (uint16_t) 1);
+
+  // Four bytes per call.
+  printer.flush();
+  processor.setBudget(4, 0, 0);
+  stream.set("args c\n");
+  stream.arrive();
+  processor.process();
+  assertEqual(printer.getCstr(), "");
+  assertEqual(processor.getNumBudgetHits(), (uint16_t) 2);
+  processor.process();
+  assertEqual(printer.getCstr(), "[args][c]");
+}
+
+test(LoopJitter_toBucket) {
+  assertEqual(LoopJitter::toBucket(0), 0);
+  assertEqual(LoopJitter::toBucket(1), 0);
+  assertEqual(LoopJitter::toBucket(2), 1);
+  assertEqual(LoopJitter::toBucket(3), 1);
+  assertEqual(LoopJitter::toBucket(1024), 10);
+  assertEqual(LoopJitter::toBucket(0xFFFFFFFF), LoopJitter::kNumBuckets - 1);
+}
+
+test(LoopJitter_outlierTag) {
+  TestStream stream;
+  PrintStr<64> printer;
+  const char* argv[ARGV_SIZE];
+  CommandDispatcher dispatcher(ARGS_COMMANDS, 1, argv, ARGV_SIZE);
+  char buf[BUF_SIZE];
+  DirectProcessor processor(stream, dispatcher, printer, buf, BUF_SIZE);
+  LoopJitter loopJitter(0);
+  processor.setLoopJitter(&loopJitter, "direct");
+
+  // An iteration without a command, then one with a command.
+  loopJitter.tick();
+  processor.process();
+  delayMicroseconds(10);
+  loopJitter.tick();
+  stream.set("args\n");
+  stream.arrive();
+  processor.process();
+  delayMicroseconds(10);
+  loopJitter.tick();
+
+  assertEqual(loopJitter.getNumOutliers(), (uint16_t) 2);
+  assertEqual(loopJitter.getOutlier(0).tag, "direct");
+  assertTrue(loopJitter.getOutlier(1).tag == nullptr);
+
+  JitterCommand jitterCommand(loopJitter);
+  PrintStr<200> output;
+  const char* const args[] = {"jitter"};
+  jitterCommand.run(output, 1, args);
+  assertTrue(strstr(output.getCstr(), "us: direct") != nullptr);
+}
+
+struct StaticArgs {
+  static const __FlashStringHelper* name() { return F("args"); }
+  static const __FlashStringHelper* helpString() { return F("[args ...]"); }
+  static void run(Print& printer, int argc, const char* const* argv) {
+    for (int i = 0; i < argc; i++) {
+      printer.print('[');
+      printer.print(argv[i]);
+      printer.print(']');
+    }
+  }
+};
+
+struct StaticHello {
+  static const __FlashStringHelper* name() { return F("hello"); }
+  static const __FlashStringHelper* helpString() { return nullptr; }
+  static void run(Print& printer, int /*argc*/, const char* const* /*argv*/) {
+    printer.print(F("hello"));
+  }
+};
+
+test(StaticProcessorManager_process) {
+  TestStream stream;
+  PrintStr<100> printer;
+  StaticProcessorManager<BUF_SIZE, ARGV_SIZE, StaticArgs, StaticHello>
+      manager(stream, printer);
+
+  stream.set("hello\nargs a b\nbye\n");
+  stream.arrive();
+  manager.process();
+  assertEqual(printer.getCstr(), "hello[args][a][b]Unknown command: 'bye'\r\n");
+
+  printer.flush();
+  stream.set("help\n");
+  stream.arrive();
+  manager.process();
+  assertEqual(printer.getCstr(),
+      "Commands:\r\n"
+      "  help [command]\r\n"
+      "  args [args ...]\r\n"
+      "  hello\r\n");
+
+  printer.flush();
+  stream.set("help args\n");
+  stream.arrive();
+  manager.process();
+  assertEqual(printer.getCstr(), "Usage: args [args ...]\r\n");
+}
+
+test(BoundCommand_invoke) {
+  const char* argv[ARGV_SIZE];
+  CommandDispatcher dispatcher(ARGS_COMMANDS, 1, argv, ARGV_SIZE);
+  PrintStr<100> printer;
+
+  char line[] = "args a b";
+  BoundCommand<16, ARGV_SIZE> bound(dispatcher, line);
+  strcpy(line, "xxxx");
+  assertEqual((int) bound.getArgc(), 3);
+  assertTrue(bound.invoke(printer) == &argsCommand);
+  assertTrue(bound.invoke(printer) == &argsCommand);
+  assertEqual(printer.getCstr(), "[args][a][b][args][a][b]");
+
+  // Same output as runCommand() for an unknown command.
+  printer.flush();
+  assertFalse(bound.bind("bye now"));
+  assertTrue(bound.invoke(printer) == nullptr);
+  assertEqual(printer.getCstr(), "Unknown command: 'bye'\r\n");
+
+  printer.flush();
+  assertTrue(bound.bind("help args"));
+  bound.invoke(printer);
+  PrintStr<100> expected;
+  char helpLine[] = "help args";
+  dispatcher.runCommand(expected, helpLine);
+  assertEqual(printer.getCstr(), expected.getCstr());
+}
+
+test(BoundCommand_lazyBind) {
+  // Simulate a table which is not yet initialized by its static
+  // constructors when the BoundCommand is constructed.
+  const CommandHandler* commands[] = {nullptr};
+  const char* argv[ARGV_SIZE];
+  CommandDispatcher dispatcher(commands, 1, argv, ARGV_SIZE);
+  BoundCommand<16, ARGV_SIZE> bound(dispatcher, "args a");
+  commands[0] = &argsCommand;
+
+  PrintStr<100> printer;
+  assertTrue(bound.invoke(printer) == &argsCommand);
+  assertEqual(printer.getCstr(), "[args][a]");
+  assertTrue(bound.bind());
+}
+
+static void progmemArgs(Print& printer, int argc, const char* const* argv) {
+  for (int i = 0; i < argc; i++) {
+    printer.print('[');
+    printer.print(argv[i]);
+    printer.print(']');
+  }
+}
+
+static void progmemHello(Print& printer, int /*argc*/,
+    const char* const* /*argv*/) {
+  printer.print(F("hello"));
+}
+
+static const char PROGMEM_ARGS_NAME[] PROGMEM = "args";
+static const char PROGMEM_ARGS_HELP[] PROGMEM = "[args ...]";
+static const char PROGMEM_HELLO_NAME[] PROGMEM = "hello";
+
+static const ProgmemCommand PROGMEM_COMMANDS[] PROGMEM = {
+  {PROGMEM_ARGS_NAME, PROGMEM_ARGS_HELP, progmemArgs},
+  {PROGMEM_HELLO_NAME, nullptr, progmemHello},
+};
+static const uint8_t NUM_PROGMEM_COMMANDS =
+    sizeof(PROGMEM_COMMANDS) / sizeof(ProgmemCommand);
+
+test(DirectProcessorManager_progmemCommands) {
+  TestStream stream;
+  PrintStr<100> printer;
+  DirectProcessorManager<BUF_SIZE, ARGV_SIZE> manager(
+      stream, PROGMEM_COMMANDS, NUM_PROGMEM_COMMANDS, printer);
+
+  stream.set("hello\nargs a b\nbye\n");
+  stream.arrive();
+  manager.process();
+  assertEqual(printer.getCstr(), "hello[args][a][b]Unknown command: 'bye'\r\n");
+
+  printer.flush();
+  stream.set("help\n");
+  stream.arrive();
+  manager.process();
+  assertEqual(printer.getCstr(),
+      "Commands:\r\n"
+      "  help [command]\r\n"
+      "  args [args ...]\r\n"
+      "  hello\r\n");
+
+  printer.flush();
+  stream.set("help args\n");
+  stream.arrive();
+  manager.process();
+  assertEqual(printer.getCstr(), "Usage: args [args ...]\r\n");
+}
+
+static const char SCHEMA_MODES[] PROGMEM = "on|off|auto";
+static const char SCHEMA_MILLIS[] PROGMEM = "millis";
+static const char SCHEMA_GAIN[] PROGMEM = "gain";
+static const char SCHEMA_NAMES[] PROGMEM = "names";
+static const ArgSpec SCHEMA[] PROGMEM = {
+  {ArgSpec::kTypeEnum, 0, SCHEMA_MODES, 0, 0},
+  {ArgSpec::kTypeInt, ArgSpec::kFlagOptional, SCHEMA_MILLIS, 1, 1000},
+  {ArgSpec::kTypeFloat, 0, SCHEMA_GAIN, 0, 0},
+  {ArgSpec::kTypeString, ArgSpec::kFlagOptional | ArgSpec::kFlagVariadic,
+      SCHEMA_NAMES, 0, 0},
+};
+static const uint8_t NUM_SCHEMA_SPECS = sizeof(SCHEMA) / sizeof(ArgSpec);
+
+test(ArgSchema_printUsage) {
+  PrintStr<100> printer;
+  ArgSchema::printUsage(printer, SCHEMA, NUM_SCHEMA_SPECS);
+  assertEqual(printer.getCstr(),
+      "(on | off | auto) [millis gain] [names ...]");
+}
+
+test(ArgSchema_parse) {
+  PrintStr<100> printer;
+  ArgValue values[5];
+
+  const char* const args1[] = {"auto"};
+  assertEqual((int) ArgSchema::parse(
+      printer, SCHEMA, NUM_SCHEMA_SPECS, 1, args1, values, 4), 1);
+  assertEqual((int) values[0].e, 2);
+
+  const char* const args2[] = {"on", "500", "1.5", "a", "b"};
+  assertEqual((int) ArgSchema::parse(
+      printer, SCHEMA, NUM_SCHEMA_SPECS, 5, args2, values, 5), 5);
+  assertEqual((int) values[0].e, 0);
+  assertEqual((long) values[1].i, 500L);
+  assertTrue(values[2].f == 1.5f);
+  assertEqual(values[3].s, "a");
+  assertEqual(values[4].s, "b");
+  assertEqual(printer.getCstr(), "");
+
+  // Too many variadic values for the 'values' array.
+  assertEqual((int) ArgSchema::parse(
+      printer, SCHEMA, NUM_SCHEMA_SPECS, 5, args2, values, 4), -1);
+  assertEqual(printer.getCstr(), "Error: Too many arguments\r\n");
+
+  // Incomplete optional group.
+  printer.flush();
+  const char* const args3[] = {"off", "500"};
+  assertEqual((int) ArgSchema::parse(
+      printer, SCHEMA, NUM_SCHEMA_SPECS, 2, args3, values, 4), -1);
+  assertEqual(printer.getCstr(), "Error: Missing argument\r\n");
+
+  // Out of range.
+  printer.flush();
+  const char* const args4[] = {"off", "5000", "1"};
+  assertEqual((int) ArgSchema::parse(
+      printer, SCHEMA, NUM_SCHEMA_SPECS, 3, args4, values, 4), -1);
+  assertEqual(printer.getCstr(), "Error: Invalid argument '5000'\r\n");
+
+  // Unknown enum.
+  printer.flush();
+  const char* const args5[] = {"of"};
+  assertEqual((int) ArgSchema::parse(
+      printer, SCHEMA, NUM_SCHEMA_SPECS, 1, args5, values, 4), -1);
+  assertEqual(printer.getCstr(), "Error: Invalid argument 'of'\r\n");
+}
+
+test(ArgSchema_parseTyped) {
+  PrintStr<100> printer;
+  ArgValue values[4];
+
+  // "on", 500, 2 as binary integers, "a"
+  ArgValue args[4];
+  args[0].s = "on";
+  args[1].i = 500;
+  args[2].i = 2;
+  args[3].s = "a";
+  const uint8_t types[] = {
+    ArgSpec::kTypeString, ArgSpec::kTypeInt, ArgSpec::kTypeInt,
+    ArgSpec::kTypeString,
+  };
+  assertEqual((int) ArgSchema::parseTyped(
+      printer, SCHEMA, NUM_SCHEMA_SPECS, 4, args, types, values, 4), 4);
+  assertEqual((int) values[0].e, 0);
+  assertEqual((long) values[1].i, 500L);
+  assertTrue(values[2].f == 2.0f);
+  assertEqual(values[3].s, "a");
+  assertEqual(printer.getCstr(), "");
+
+  // Out of range.
+  args[1].i = 5000;
+  assertEqual((int) ArgSchema::parseTyped(
+      printer, SCHEMA, NUM_SCHEMA_SPECS, 3, args, types, values, 4), -1);
+  assertEqual(printer.getCstr(), "Error: Invalid argument '5000'\r\n");
+
+  // An integer is not an enum.
+  printer.flush();
+  const uint8_t intTypes[] = { ArgSpec::kTypeInt };
+  assertEqual((int) ArgSchema::parseTyped(
+      printer, SCHEMA, NUM_SCHEMA_SPECS, 1, args + 1, intTypes, values, 4),
+      -1);
+  assertEqual(printer.getCstr(), "Error: Invalid argument '5000'\r\n");
+}
+
+class SchemaCommand: public SchemaCommandHandler {
+  public:
+    SchemaCommand():
+        SchemaCommandHandler(F("mode"), SCHEMA, NUM_SCHEMA_SPECS) {}
+
+  protected:
+    void runArgs(Print& printer, const ArgValue* args, uint8_t numArgs)
+        const override {
+      printer.print(numArgs);
+      printer.print(' ');
+      printer.println(args[0].e);
+    }
+};
+
+static SchemaCommand schemaCommand;
+static const CommandHandler* const SCHEMA_COMMANDS[] = {
+  &schemaCommand,
+};
+
+test(SchemaCommandHandler_run) {
+  const char* argv[ARGV_SIZE];
+  CommandDispatcher dispatcher(SCHEMA_COMMANDS, 1, argv, ARGV_SIZE);
+  PrintStr<200> printer;
+
+  char line1[] = "mode off 10 2";
+  dispatcher.runCommand(printer, line1);
+  assertEqual(printer.getCstr(), "3 1\r\n");
+
+  printer.flush();
+  char line2[] = "mode off x 2";
+  dispatcher.runCommand(printer, line2);
+  assertEqual(printer.getCstr(),
+      "Error: Invalid argument 'x'\r\n"
+      "Usage: mode (on | off | auto) [millis gain] [names ...]\r\n");
+
+  printer.flush();
+  char line3[] = "help";
+  dispatcher.runCommand(printer, line3);
+  assertEqual(printer.getCstr(),
+      "Commands:\r\n"
+      "  help [command]\r\n"
+      "  mode (on | off | auto) [millis gain] [names ...]\r\n");
+}
+
+test(QueueProcessorManager_dropsWhenFull) {
+  TestStream stream;
+  PrintStr<64> printer;
+  QueueProcessorManager<BUF_SIZE, ARGV_SIZE, 2> manager(
+      stream, ARGS_COMMANDS, 1, printer);
+
+  // The reader drains all 3 lines without waiting for the processor,
+  // yielding after each line, but there are only 2 slots, so the third line
+  // is dropped.
+  stream.set("args a\nargs b\nargs c\n");
+  stream.arrive();
+  for (uint8_t i = 0; i < 3; i++) {
+    manager.getQueueReader().runCoroutine();
+  }
+  assertEqual(stream.available(), 0);
+  assertEqual(manager.getLineQueue().getDepth(), 2);
+  assertEqual(manager.getLineQueue().getNumDropped(), 1);
+
+  for (uint8_t i = 0; i < 3; i++) {
+    manager.getQueueProcessor().runCoroutine();
+  }
+  assertEqual(printer.getCstr(), "[args][a][args][b]");
+  assertEqual(manager.getLineQueue().getDepth(), 0);
+  assertEqual(manager.getLineQueue().getMaxDepth(), 2);
+
+  // Freed slots are reused.
+  printer.flush();
+  stream.set("args d\n");
+  stream.arrive();
+  manager.getQueueReader().runCoroutine();
+  manager.getQueueProcessor().runCoroutine();
+  assertEqual(printer.getCstr(), "[args][d]");
+}
+
+// CRLF and empty lines take no extra slot, and the tail of an overflowed
+// line is discarded without taking a slot.
+test(QueueReaderCoroutine_crlfAndOverflow) {
+  TestStream stream;
+  PrintStr<64> printer;
+  QueueProcessorManager<8, ARGV_SIZE, 2> manager(
+      stream, ARGS_COMMANDS, 1, printer);
+
+  stream.set("args a\r\n\r\nargs b\r\n");
+  stream.arrive();
+  for (uint8_t i = 0; i < 3; i++) {
+    manager.getQueueReader().runCoroutine();
+  }
+  assertEqual(manager.getLineQueue().getDepth(), 2);
+  assertEqual(manager.getLineQueue().getNumDropped(), 0);
+  for (uint8_t i = 0; i < 3; i++) {
+    manager.getQueueProcessor().runCoroutine();
+  }
+  assertEqual(printer.getCstr(), "[args][a][args][b]");
+
+  printer.flush();
+  stream.set("args 0123456789\nargs c\n");
+  stream.arrive();
+  for (uint8_t i = 0; i < 3; i++) {
+    manager.getQueueReader().runCoroutine();
+  }
+  assertEqual(manager.getLineQueue().getDepth(), 2);
+  for (uint8_t i = 0; i < 3; i++) {
+    manager.getQueueProcessor().runCoroutine();
+  }
+  assertEqual(printer.getCstr(), "BufferOverflow: args 01\r\n[args][c]");
+}
+
+/** A Print device which accepts only 'room' bytes at a time. */
+class SlowPrint: public Print {
+  public:
+    size_t write(uint8_t c) override {
+      if (room == 0) return 0;
+      room--;
+      return out.write(c);
+    }
+
+    int availableForWrite() override { return room; }
+
+    PrintStr<64> out;
+    int room = 0;
+};
+
+test(BufferedPrint_drain) {
+  SlowPrint slow;
+  char buf[8];
+  BufferedPrint bufferedPrint(slow, buf, sizeof(buf));
+
+  assertEqual(bufferedPrint.print("hello"), (size_t) 5);
+  assertEqual(bufferedPrint.getNumPending(), (uint16_t) 5);
+
+  // Drain only what the device can accept.
+  slow.room = 3;
+  assertEqual(bufferedPrint.drain(), (uint16_t) 3);
+  assertEqual(slow.out.getCstr(), "hel");
+
+  // Wrap around the end of the ring.
+  bufferedPrint.print("world");
+  assertEqual(bufferedPrint.getNumPending(), (uint16_t) 7);
+  slow.room = 100;
+  assertEqual(bufferedPrint.drain(), (uint16_t) 7);
+  assertEqual(slow.out.getCstr(), "helloworld");
+  assertTrue(bufferedPrint.isEmpty());
+  assertEqual(bufferedPrint.getMaxPending(), (uint16_t) 7);
+}
+
+test(BufferedPrint_truncate) {
+  SlowPrint slow;
+  char buf[4];
+  BufferedPrint bufferedPrint(
+      slow, buf, sizeof(buf), BufferedPrint::kPolicyTruncate);
+
+  assertEqual(bufferedPrint.print("abcdef"), (size_t) 4);
+  assertEqual(bufferedPrint.getNumTruncated(), (uint32_t) 2);
+  slow.room = 100;
+  bufferedPrint.drain();
+  assertEqual(slow.out.getCstr(), "abcd");
+}
+
+test(BufferedPrint_yieldWithoutAvailableForWrite) {
+  // PrintStr does not implement availableForWrite(), which returns 0.
+  PrintStr<16> printer;
+  char buf[4];
+  BufferedPrint bufferedPrint(
+      printer, buf, sizeof(buf), BufferedPrint::kPolicyYield);
+
+  assertEqual(bufferedPrint.print("abcdef"), (size_t) 6);
+  bufferedPrint.drainAll();
+  assertEqual(printer.getCstr(), "abcdef");
+}
+
+/** A Print which collects raw bytes, including NUL. */
+class BytePrint: public Print {
+  public:
+    size_t write(uint8_t c) override {
+      if (len >= sizeof(buf)) return 0;
+      buf[len++] = c;
+      return 1;
+    }
+
+    using Print::write;
+
+    uint8_t buf[300];
+    size_t len = 0;
+};
+
+test(BinaryFrame_roundTrip) {
+  // A full block of 254 non-zero bytes, which has no implicit zero.
+  uint8_t data[254];
+  for (uint16_t i = 0; i < sizeof(data); i++) data[i] = i + 1;
+
+  BytePrint encoded;
+  BinaryFrame::encode(encoded, data, sizeof(data));
+  assertEqual(encoded.len, (size_t) 256);
+  assertEqual(encoded.buf[encoded.len - 1], 0);
+  assertTrue(memchr(encoded.buf, 0, encoded.len - 1) == nullptr);
+  int16_t len = BinaryFrame::decode(encoded.buf, encoded.len - 1);
+  assertEqual(len, (int16_t) sizeof(data));
+  assertEqual(memcmp(encoded.buf, data, sizeof(data)), 0);
+
+  // A trailing zero.
+  const uint8_t tail[] = { 1, 0 };
+  BytePrint encodedTail;
+  BinaryFrame::encode(encodedTail, tail, sizeof(tail));
+  assertEqual(encodedTail.len, (size_t) 4);
+  len = BinaryFrame::decode(encodedTail.buf, encodedTail.len - 1);
+  assertEqual(len, (int16_t) sizeof(tail));
+  assertEqual(memcmp(encodedTail.buf, tail, sizeof(tail)), 0);
+}
+
+test(FrameProcessorManager_request) {
+  TestStream stream;
+  BytePrint printer;
+  FrameProcessorManager<32, ARGV_SIZE, 32> manager(
+      stream, ARGS_COMMANDS, 1, printer);
+
+  // reqId=7, cmdId=0, "a", -5
+  uint8_t request[16] = {
+    7, 0,
+    BinaryFrame::kArgString, 'a', 0,
+    BinaryFrame::kArgInt32, 0xFB, 0xFF, 0xFF, 0xFF,
+  };
+  uint16_t crc = ace_crc::crc16ccitt_nibble::crc_calculate(request, 10);
+  request[10] = crc >> 8;
+  request[11] = crc & 0xFF;
+  // Same request with an unknown cmdId=3
+  uint8_t badRequest[4] = { 8, 3 };
+  crc = ace_crc::crc16ccitt_nibble::crc_calculate(badRequest, 2);
+  badRequest[2] = crc >> 8;
+  badRequest[3] = crc & 0xFF;
+
+  BytePrint frames;
+  BinaryFrame::encode(frames, request, 12);
+  BinaryFrame::encode(frames, badRequest, 4);
+  stream.setBytes((const char*) frames.buf, frames.len);
+  stream.arrive();
+  manager.process();
+
+  // First response
+  uint8_t* end = (uint8_t*) memchr(printer.buf, 0, printer.len);
+  assertTrue(end != nullptr);
+  int16_t len = BinaryFrame::decode(printer.buf, end - printer.buf);
+  const char expected[] = "[args][a][-5]";
+  assertEqual(len, (int16_t) (2 + strlen(expected) + 2));
+  assertEqual(printer.buf[0], 7);
+  assertEqual(printer.buf[1], BinaryFrame::kStatusOk);
+  assertEqual(memcmp(printer.buf + 2, expected, strlen(expected)), 0);
+  crc = ace_crc::crc16ccitt_nibble::crc_calculate(printer.buf, len - 2);
+  assertEqual(printer.buf[len - 2], (uint8_t) (crc >> 8));
+  assertEqual(printer.buf[len - 1], (uint8_t) (crc & 0xFF));
+
+  // Second response
+  uint8_t* start = end + 1;
+  len = BinaryFrame::decode(start, printer.buf + printer.len - start - 1);
+  assertEqual(len, (int16_t) 4);
+  assertEqual(start[0], 8);
+  assertEqual(start[1], BinaryFrame::kStatusUnknownCommand);
+}
+
+/** Append the CRC to the request, then write it as a frame. */
+static void writeRequest(Print& out, uint8_t* request, uint8_t len) {
+  uint16_t crc = ace_crc::crc16ccitt_nibble::crc_calculate(request, len);
+  request[len] = crc >> 8;
+  request[len + 1] = crc & 0xFF;
+  BinaryFrame::encode(out, request, len + 2);
+}
+
+static const char FLASH_ARGS_NAME[] PROGMEM = "fargs";
+
+/** Same as ArgsCommand, with a name in flash memory. */
+class FlashArgsCommand: public CommandHandler {
+  public:
+    FlashArgsCommand():
+        CommandHandler((const __FlashStringHelper*) FLASH_ARGS_NAME, nullptr)
+    {}
+
+    void run(Print& printer, int argc, const char* const* argv)
+        const override {
+      argsCommand.run(printer, argc, argv);
+    }
+};
+
+test(FrameProcessorManager_longRunningCommand) {
+  static FlashArgsCommand flashArgsCommand;
+  static const CommandHandler* const commands[] = {
+    &countdownCommand,
+    &flashArgsCommand,
+  };
+  TestStream stream;
+  BytePrint printer;
+  FrameProcessorManager<32, ARGV_SIZE, 32> manager(
+      stream, commands, 2, printer);
+
+  // "countdown 2", then "fargs x"
+  BytePrint frames;
+  uint8_t countdown[10] = {1, 0, BinaryFrame::kArgInt32, 2, 0, 0, 0};
+  writeRequest(frames, countdown, 7);
+  uint8_t args[8] = {2, 1, BinaryFrame::kArgString, 'x', 0};
+  writeRequest(frames, args, 5);
+  stream.setBytes((const char*) frames.buf, frames.len);
+  stream.arrive();
+
+  // The countdown is polled once per process(), and no response is sent
+  // until it finishes.
+  manager.process();
+  assertEqual(printer.len, (size_t) 0);
+  manager.process();
+
+  uint8_t* end = (uint8_t*) memchr(printer.buf, 0, printer.len);
+  assertTrue(end != nullptr);
+  int16_t len = BinaryFrame::decode(printer.buf, end - printer.buf);
+  assertEqual(len, (int16_t) (2 + 2 + 2));
+  assertEqual(printer.buf[0], 1);
+  assertEqual(printer.buf[1], BinaryFrame::kStatusOk);
+  assertEqual(memcmp(printer.buf + 2, "21", 2), 0);
+
+  // The argv[0] of a command named by an F() string is its name.
+  uint8_t* start = end + 1;
+  len = BinaryFrame::decode(start, printer.buf + printer.len - start - 1);
+  const char expected[] = "[fargs][x]";
+  assertEqual(len, (int16_t) (2 + strlen(expected) + 2));
+  assertEqual(start[0], 2);
+  assertEqual(memcmp(start + 2, expected, strlen(expected)), 0);
+}
+
+// The integers of a request for a SchemaCommandHandler are not formatted
+// into text, so the manager needs no buffer for the text of the numbers, nor
+// for the name of the command in flash memory.
+test(FrameProcessorManager_typedArgs) {
+  TestStream stream;
+  BytePrint printer;
+  FrameProcessorManager<32, ARGV_SIZE, 32, 0> manager(
+      stream, SCHEMA_COMMANDS, 1, printer);
+
+  // "mode off 10 2" and "mode off 5000 2"
+  BytePrint frames;
+  uint8_t valid[20] = {
+    1, 0,
+    BinaryFrame::kArgString, 'o', 'f', 'f', 0,
+    BinaryFrame::kArgInt32, 10, 0, 0, 0,
+    BinaryFrame::kArgInt32, 2, 0, 0, 0,
+  };
+  writeRequest(frames, valid, 17);
+  uint8_t invalid[20] = {
+    2, 0,
+    BinaryFrame::kArgString, 'o', 'f', 'f', 0,
+    BinaryFrame::kArgInt32, 0x88, 0x13, 0, 0,
+    BinaryFrame::kArgInt32, 2, 0, 0, 0,
+  };
+  writeRequest(frames, invalid, 17);
+  stream.setBytes((const char*) frames.buf, frames.len);
+  stream.arrive();
+  manager.process();
+
+  uint8_t* end = (uint8_t*) memchr(printer.buf, 0, printer.len);
+  assertTrue(end != nullptr);
+  int16_t len = BinaryFrame::decode(printer.buf, end - printer.buf);
+  const char expected[] = "3 1\r\n";
+  assertEqual(len, (int16_t) (2 + strlen(expected) + 2));
+  assertEqual(printer.buf[1], BinaryFrame::kStatusOk);
+  assertEqual(memcmp(printer.buf + 2, expected, strlen(expected)), 0);
+
+  // The error message shows the integer, and is truncated to the frame.
+  uint8_t* start = end + 1;
+  len = BinaryFrame::decode(start, printer.buf + printer.len - start - 1);
+  const char error[] = "Error: Invalid argument '5000'";
+  assertEqual(start[0], 2);
+  assertEqual(start[1], BinaryFrame::kStatusTruncated);
+  assertEqual(memcmp(start + 2, error, 28), 0);
+}
+
+test(SessionProcessorManager_sharedBuffer) {
+  TestStream stream0;
+  TestStream stream1;
+  PrintStr<64> printer0;
+  PrintStr<64> printer1;
+  SessionProcessor session0(stream0, printer0);
+  SessionProcessor session1(stream1, printer1);
+  SessionProcessor* const sessions[] = { &session0, &session1 };
+
+  // Only 1 line buffer for 2 sessions.
+  SessionProcessorManager<BUF_SIZE, ARGV_SIZE, 1> manager(
+      sessions, 2, ARGS_COMMANDS, 1);
+
+  // Session 0 gets a partial line, and keeps the only buffer.
+  stream0.set("args a\n", 4);
+  stream1.set("args b\n");
+  stream0.arrive();
+  stream1.arrive();
+  manager.process();
+  assertTrue(session0.isActive());
+  assertFalse(session1.isActive());
+  assertEqual(manager.getBufferPool().getNumFree(), 0);
+  assertEqual(manager.getBufferPool().getNumStarved(), 1);
+
+  // Session 0 completes its line, and releases the buffer, which is then
+  // used by session 1.
+  stream0.arrive();
+  manager.process();
+  assertEqual(printer0.getCstr(), "[args][a]");
+  assertFalse(session0.isActive());
+  assertEqual(printer1.getCstr(), "[args][b]");
+  assertFalse(session1.isActive());
+  assertEqual(manager.getBufferPool().getNumFree(), 1);
+  assertEqual(manager.getBufferPool().getMaxInUse(), 1);
+}
+
+/** Prints a fixed line, and a line with a counter in the given argv[1]. */
+class StatusCommand: public CommandHandler {
+  public:
+    StatusCommand(): CommandHandler("status", nullptr) {}
+
+    void run(Print& printer, int argc, const char* const* argv)
+        const override {
+      printer.println(F("uptime"));
+      printer.println(argc > 1 ? argv[1] : "-");
+      if (extra) printer.println(F("extra"));
+    }
+
+    bool extra = false;
+};
+
+static StatusCommand statusCommand;
+
+test(WatchCoroutine_changedLines) {
+  PrintStr<100> printer;
+  WatchManager<32, ARGV_SIZE, 64> watchManager(printer);
+  const CommandHandler* const commands[] = {
+    &statusCommand,
+    &watchManager.getWatchCommand(),
+  };
+  // The watch is attached to a coroutine processor through its manager.
+  TestStream stream;
+  QueueProcessorManager<BUF_SIZE, ARGV_SIZE, 2> manager(
+      stream, commands, 2, printer);
+  const CommandDispatcher& dispatcher = manager.getCommandDispatcher();
+  watchManager.setDispatcher(&dispatcher);
+  WatchCoroutine& watch = watchManager.getWatchCoroutine();
+
+  // The Print given to the watch command is not used after it returns.
+  {
+    PrintStr<16> commandPrinter;
+    char line1[] = "watch 1000 status a";
+    dispatcher.runCommand(commandPrinter, line1);
+    assertEqual(commandPrinter.getCstr(), "");
+  }
+  assertTrue(watch.isWatching());
+
+  // All lines are printed on the first run.
+  statusCommand.extra = true;
+  watch.runOnce();
+  assertEqual(printer.getCstr(), "0:uptime\r\n1:a\r\n2:extra\r\n");
+
+  // Nothing changed.
+  printer.flush();
+  watch.runOnce();
+  assertEqual(printer.getCstr(), "");
+
+  // Only the removed line is printed.
+  printer.flush();
+  statusCommand.extra = false;
+  watch.runOnce();
+  assertEqual(printer.getCstr(), "2:\r\n");
+  assertEqual(watch.getNumBytesCaptured(), (uint32_t) (2 * 18 + 11));
+
+  // Watching 'watch' is rejected, and stops the watch.
+  printer.flush();
+  char line2[] = "watch 1000 watch";
+  dispatcher.runCommand(printer, line2);
+  assertEqual(printer.getCstr(), "Error: Cannot watch 'watch'\r\n");
+
+  char line3[] = "watch";
+  dispatcher.runCommand(printer, line3);
+  assertFalse(watch.isWatching());
+}
+
+test(NumberFormat_decimal) {
+  const int32_t values[] = {
+    0, 7, 10, 99, 100, 9999, 10000, 123456, 2147483647, -1, -100, -2147483647,
+  };
+  PrintStr<20> expected;
+  PrintStr<20> actual;
+  for (uint8_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+    expected.flush();
+    actual.flush();
+    expected.print(values[i]);
+    assertEqual(NumberFormat::printInt(actual, values[i]),
+        strlen(expected.getCstr()));
+    assertEqual(actual.getCstr(), expected.getCstr());
+  }
+
+  actual.flush();
+  NumberFormat::printInt(actual, INT32_MIN);
+  assertEqual(actual.getCstr(), "-2147483648");
+  actual.flush();
+  NumberFormat::printUint(actual, 4294967295UL);
+  assertEqual(actual.getCstr(), "4294967295");
+
+  actual.flush();
+  NumberFormat::printFixed(actual, -1234, 2);
+  assertEqual(actual.getCstr(), "-12.34");
+  actual.flush();
+  NumberFormat::printFixed(actual, 5, 3);
+  assertEqual(actual.getCstr(), "0.005");
+  actual.flush();
+  NumberFormat::printFixed(actual, -5, 1);
+  assertEqual(actual.getCstr(), "-0.5");
+  actual.flush();
+  NumberFormat::printFixed(actual, 42, 0);
+  assertEqual(actual.getCstr(), "42");
+}
+
+test(NumberFormat_hex) {
+  PrintStr<200> printer;
+  assertEqual(NumberFormat::printHex(printer, 0x1F, 4), (size_t) 4);
+  assertEqual(printer.getCstr(), "001F");
+  printer.flush();
+  NumberFormat::printHex(printer, 0xDEADBEEF, 8);
+  assertEqual(printer.getCstr(), "DEADBEEF");
+
+  const uint8_t data[] = "Hello\x00\xff AceUtils!";
+  printer.flush();
+  NumberFormat::printHexDump(printer, 0x10, data, sizeof(data));
+  assertEqual(printer.getCstr(),
+      "0010: 48 65 6C 6C 6F 00 FF 20 41 63 65 55 74 69 6C 73  "
+      "Hello.. AceUtils\r\n"
+      "0020: 21 00                                            "
+      "!.\r\n");
+}
+
+test(EventLog_format) {
+  FixedEventLog<3> eventLog;
+  eventLog.log(F("start"));
+  eventLog.log(F("id=%u rssi=%d"), 7, -42);
+  eventLog.log(F("flags=0x%x %c 100%%"), 0x1F, 'A');
+  assertEqual(eventLog.getCount(), (uint16_t) 3);
+
+  PrintStr<64> printer;
+  EventLog::printMessage(printer, eventLog.getEntry(1));
+  assertEqual(printer.getCstr(), "id=7 rssi=-42");
+  printer.flush();
+  EventLog::printMessage(printer, eventLog.getEntry(2));
+  assertEqual(printer.getCstr(), "flags=0x1F A 100%");
+
+  // Wrap around, overwriting the 2 oldest events.
+  eventLog.log(F("a=%u"), 1);
+  eventLog.log(F("a=%u %u"), 2);
+  assertEqual(eventLog.getCount(), (uint16_t) 3);
+  assertEqual(eventLog.getNumLogged(), (uint32_t) 5);
+  assertEqual(eventLog.getNumDropped(), (uint32_t) 2);
+  assertEqual(eventLog.getSequence(0), (uint32_t) 2);
+  printer.flush();
+  EventLog::printMessage(printer, eventLog.getEntry(2));
+  assertEqual(printer.getCstr(), "a=2 <?>");
+}
+
+test(EventLogCommand_run) {
+  FixedEventLog<4> eventLog;
+  EventLogCommand logCommand(eventLog);
+  for (uint8_t i = 0; i < 6; i++) {
+    eventLog.log(F("i=%u"), i);
+  }
+
+  PrintStr<100> printer;
+  const char* const argv[] = {"log", "tail", "2"};
+  logCommand.run(printer, 3, argv);
+
+  PrintStr<100> expected;
+  expected.println(F("Events: logged=6; dropped=2"));
+  for (uint16_t i = 2; i < 4; i++) {
+    expected.print('#');
+    expected.print(eventLog.getSequence(i));
+    expected.print(' ');
+    expected.print(eventLog.getEntry(i).millis);
+    expected.print(F(": i="));
+    expected.println(i + 2);
+  }
+  assertEqual(printer.getCstr(), expected.getCstr());
+
+  const char* const clearArgv[] = {"log", "clear"};
+  logCommand.run(printer, 2, clearArgv);
+  assertEqual(eventLog.getCount(), (uint16_t) 0);
+  printer.flush();
+  logCommand.run(printer, 1, argv);
+  assertEqual(printer.getCstr(), "Events: logged=0; dropped=0\r\n");
+
+  const char* const badArgv[] = {"log", "tail", "x"};
+  printer.flush();
+  logCommand.run(printer, 3, badArgv);
+  assertEqual(printer.getCstr(), "Usage: log [tail [n] | clear]\r\n");
+}
+
+/**
+ * Logs 2 events at each newline that it prints, like an interrupt handler
+ * which logs events while the log is being dumped.
+ */
+class LoggingPrint: public Print {
+  public:
+    LoggingPrint(EventLog& eventLog): mEventLog(eventLog) {}
+
+    size_t write(uint8_t c) override {
+      if (c == '\n') {
+        mEventLog.log(F("isr"));
+        mEventLog.log(F("isr"));
+      }
+      return mPrinter.write(c);
+    }
+
+    const char* getCstr() { return mPrinter.getCstr(); }
+
+  private:
+    EventLog& mEventLog;
+    PrintStr<100> mPrinter;
+};
+
+// The events overwritten while they are printed are skipped.
+test(EventLog_printWhileLogging) {
+  FixedEventLog<4> eventLog;
+  for (uint8_t i = 0; i < 4; i++) {
+    eventLog.log(F("i=%u"), i);
+  }
+
+  // Printing #0 overwrites #0 and #1, printing #2 overwrites #2 and #3.
+  LoggingPrint printer(eventLog);
+  assertEqual(eventLog.printTo(printer), (uint16_t) 2);
+  const char* output = printer.getCstr();
+  assertEqual(strncmp(output, "#0 ", 3), 0);
+  const char* second = strstr(output, "\n#");
+  assertTrue(second != nullptr);
+  assertEqual(strncmp(second, "\n#2 ", 4), 0);
+  assertTrue(strstr(output, ": i=0\r\n") != nullptr);
+  assertTrue(strstr(output, ": i=2\r\n") != nullptr);
+  assertTrue(strstr(output, "i=1") == nullptr);
+  assertTrue(strstr(output, "i=3") == nullptr);
+}
+
+test(ScratchArena_allocate) {
+  FixedScratchArena<16> arena;
+  char* a = arena.allocate<char>(3);
+  assertTrue(a != nullptr);
+  uint32_t* b = arena.allocate<uint32_t>(2);
+  assertTrue(b != nullptr);
+  assertEqual((uintptr_t) b % alignof(uint32_t), (uintptr_t) 0);
+  assertMore((char*) b, a + 2);
+  assertTrue(arena.allocate(16) == nullptr);
+  assertEqual(arena.getNumFailures(), (uint16_t) 1);
+
+  uint16_t used = arena.getUsed();
+  arena.reset();
+  assertEqual(arena.getUsed(), (uint16_t) 0);
+  assertEqual(arena.getPeakUsed(), used);
+  assertTrue(arena.allocate(16) != nullptr);
+  assertEqual(arena.getPeakUsed(), (uint16_t) 16);
+}
+
+test(ScratchArena_empty) {
+  ScratchArena& arena = ScratchArena::getEmpty();
+  assertTrue(&arena == &ScratchArena::getEmpty());
+  assertEqual(arena.getSize(), (uint16_t) 0);
+  assertTrue(arena.allocate(0) == nullptr);
+  assertTrue(arena.allocate<uint32_t>(1) == nullptr);
+  assertEqual(arena.getUsed(), (uint16_t) 0);
+}
+
+/** Reverses its argument into a buffer taken from the ScratchArena. */
+class ReverseCommand: public ArenaCommandHandler {
+  public:
+    ReverseCommand(): ArenaCommandHandler("reverse", "string") {}
+
+    void runWithArena(Print& printer, int argc, const char* const* argv,
+        ScratchArena& arena) const override {
+      if (argc != 2) return;
+      uint16_t len = strlen(argv[1]);
+      char* buf = arena.allocate<char>(len + 1);
+      if (buf == nullptr) {
+        printer.println(F("Error: Out of scratch memory"));
+        return;
+      }
+      for (uint16_t i = 0; i < len; i++) buf[i] = argv[1][len - 1 - i];
+      buf[len] = '\0';
+      printer.print(buf);
+    }
+};
+
+static ReverseCommand reverseCommand;
+static const CommandHandler* const ARENA_COMMANDS[] = {
+  &reverseCommand,
+  &argsCommand,
+};
+
+test(DirectProcessorManager_scratchArena) {
+  TestStream stream;
+  PrintStr<64> printer;
+  DirectProcessorManager<BUF_SIZE, ARGV_SIZE> manager(
+      stream, ARENA_COMMANDS, 2, printer);
+
+  // Without an arena, every allocation fails.
+  stream.set("reverse abc\n");
+  stream.arrive();
+  manager.process();
+  assertEqual(printer.getCstr(), "Error: Out of scratch memory\r\n");
+
+  // The arena is reset after each command, so the second command fits.
+  FixedScratchArena<8> arena;
+  manager.setScratchArena(&arena);
+  printer.flush();
+  stream.set("reverse abcde\nreverse xyz\nargs a\n");
+  stream.arrive();
+  manager.process();
+  assertEqual(printer.getCstr(), "edcbazyx[args][a]");
+  assertEqual(arena.getUsed(), (uint16_t) 0);
+  assertEqual(arena.getPeakUsed(), (uint16_t) 6);
+
+  printer.flush();
+  stream.set("reverse abcdefgh\n");
+  stream.arrive();
+  manager.process();
+  assertEqual(printer.getCstr(), "Error: Out of scratch memory\r\n");
+  assertEqual(arena.getNumFailures(), (uint16_t) 1);
+}
+
+test(RingBufferStream_putRead) {
+  FixedRingBufferStream<8> ring;
+  assertEqual(ring.available(), 0);
+  assertEqual(ring.read(), -1);
+
+  assertTrue(ring.put('x'));
+  assertTrue(ring.put('y'));
+  assertEqual(ring.peek(), 'x');
+  assertEqual(ring.read(), 'x');
+  assertEqual(ring.read(), 'y');
+
+  // The ring holds only 8 bytes, and wraps around the end of the buffer.
+  assertEqual(ring.put((const uint8_t*) "args a\nbc", 9), (uint16_t) 8);
+  assertEqual(ring.getNumOverruns(), (uint32_t) 1);
+  assertEqual(ring.getHighWater(), (uint16_t) 8);
+  assertEqual(ring.availableForWrite(), 0);
+  assertFalse(ring.put('d'));
+  assertEqual(ring.getNumOverruns(), (uint32_t) 2);
+
+  PrintStr<64> printer;
+  const char* argv[ARGV_SIZE];
+  CommandDispatcher dispatcher(ARGS_COMMANDS, 1, argv, ARGV_SIZE);
+  char lineBuf[BUF_SIZE];
+  DirectProcessor processor(ring, dispatcher, printer, lineBuf, BUF_SIZE);
+  processor.process();
+  assertEqual(printer.getCstr(), "[args][a]");
+  assertEqual(ring.available(), 0);
+  assertEqual(ring.availableForWrite(), 8);
+}
+
 // ---------------------------------------------------------------------------
 
 void setup() {
@@ -0,0 +1,116 @@
+#line 2 "CliWideLinesTest.ino"
+
+/*
+ * Tests of the line buffers larger than 255 bytes of the cli/ library. The
+ * ACE_UTILS_CLI_WIDE_LINES macro changes the size of LineReader, so it must be
+ * defined for all translation units by the Makefile, instead of being defined
+ * in this file. Without it, no tests are compiled.
+ */
+
+#include <Arduino.h> // Print
+#include <AceCommon.h> // PrintStr
+#include <AUnitVerbose.h>
+#include <AceUtils.h>
+#include <cli/cli.h> // from AceUtils.h
+
+using aunit::TestRunner;
+using ace_utils::cli::CommandHandler;
+using ace_utils::cli::CommandDispatcher;
+using ace_utils::cli::TokenSpan;
+using ace_utils::cli::DirectProcessorManager;
+using ace_common::PrintStr;
+
+#if ACE_UTILS_CLI_WIDE_LINES
+
+// A command that prints the length of each argument.
+class LengthCommand: public CommandHandler {
+  public:
+    LengthCommand(): CommandHandler("len", nullptr) {}
+
+    void run(Print& printer, int argc, const char* const* argv)
+        const override {
+      for (int i = 1; i < argc; i++) {
+        printer.print(strlen(argv[i]));
+        printer.print(' ');
+      }
+    }
+};
+
+static LengthCommand lengthCommand;
+
+static const CommandHandler* const COMMANDS[] = {
+  &lengthCommand,
+};
+
+static const uint8_t ARGV_SIZE = 4;
+static const uint16_t BUF_SIZE = 400;
+
+// A Stream which returns the given string.
+class StringStream: public Stream {
+  public:
+    explicit StringStream(const char* s): mString(s) {}
+
+    int available() override { return strlen(mString); }
+
+    int read() override {
+      return (*mString == '\0') ? -1 : *mString++;
+    }
+
+    int peek() override {
+      return (*mString == '\0') ? -1 : *mString;
+    }
+
+    size_t write(uint8_t) override { return 0; }
+
+  private:
+    const char* mString;
+};
+
+test(wideLine) {
+  // A line of 4 + 300 + 1 + 10 bytes, longer than 255.
+  static char line[400];
+  strcpy(line, "len ");
+  memset(line + 4, 'a', 300);
+  strcpy(line + 304, " 0123456789\n");
+
+  StringStream stream(line);
+  PrintStr<64> printer;
+  DirectProcessorManager<BUF_SIZE, ARGV_SIZE> manager(
+      stream, COMMANDS, 1, printer);
+
+  manager.process();
+  assertEqual(printer.getCstr(), "300 10 ");
+}
+
+test(tokenizeSpans_wideLine) {
+  // The offsets of the tokens after the first 255 bytes do not fit in a
+  // uint8_t.
+  static char line[400];
+  strcpy(line, "len ");
+  memset(line + 4, 'a', 300);
+  strcpy(line + 304, " 0123456789");
+
+  TokenSpan spans[ARGV_SIZE];
+  uint8_t count = CommandDispatcher::tokenizeSpans(line, spans, ARGV_SIZE);
+  assertEqual(count, 3);
+  assertEqual(spans[1].offset, 4);
+  assertEqual(spans[1].length, 300);
+  assertEqual(spans[2].offset, 305);
+  assertEqual(spans[2].length, 10);
+}
+
+#endif
+
+//---------------------------------------------------------------------------
+
+void setup() {
+#if defined(ARDUINO)
+  delay(1000); // some boards reboot twice
+#endif
+  Serial.begin(115200);
+  while (!Serial); // Leonardo/Micro
+}
+
+void loop() {
+  TestRunner::run();
+}